@@ -0,0 +1,290 @@
+/*! \file benchmark.c
+ *  \brief Startup time measurements.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common.h"
+#include <time.h>
+
+/*
+ * When started with --benchmark-startup[=file], the game records how long each
+ * startup stage took and quits right after the menu draws its first frame,
+ * dumping the results as JSON (to stdout when no file is given).
+ *
+ * All times are in seconds since the process started: main() reads
+ * BenchmarkClock() before anything else and StartBenchmark maps al_get_time()
+ * onto that origin, so the stages before Allegro's initialization count too.
+ *
+ * --benchmark-board[=file] runs the micro-benchmarks of the board logic
+ * instead, optionally comparing them with --benchmark-baseline=file.
+ *
+ * --benchmark-stress[=file] keeps playing the infinite level for
+ * --benchmark-minutes=N (10 by default), with animations sped up by
+ * --benchmark-speed=N times (1 by default).
+ */
+
+#ifdef ANIMATCH_COUNT_ALLOCATIONS
+// glibc only: wrap every allocation entry point of its allocator to count the heap
+// allocations made by benchmarked code. The __libc_* functions are what glibc's own
+// public wrappers forward to, so free has to be wrapped along with the rest for
+// every block to stay within the same allocator.
+#include <errno.h>
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void* __libc_valloc(size_t size);
+extern void* __libc_pvalloc(size_t size);
+extern void __libc_free(void* ptr);
+
+static long allocations = 0;
+
+static inline void CountAllocation(void) {
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+}
+
+void* malloc(size_t size) {
+	CountAllocation();
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+	CountAllocation();
+	return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+	CountAllocation();
+	return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+	CountAllocation();
+	return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+	CountAllocation();
+	return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** memptr, size_t alignment, size_t size) {
+	if (!alignment || (alignment % sizeof(void*)) || (alignment & (alignment - 1))) {
+		return EINVAL;
+	}
+	CountAllocation();
+	void* ptr = __libc_memalign(alignment, size);
+	if (!ptr) {
+		return ENOMEM;
+	}
+	*memptr = ptr;
+	return 0;
+}
+
+void* valloc(size_t size) {
+	CountAllocation();
+	return __libc_valloc(size);
+}
+
+void* pvalloc(size_t size) {
+	CountAllocation();
+	return __libc_pvalloc(size);
+}
+
+void free(void* ptr) {
+	__libc_free(ptr);
+}
+
+long BenchmarkAllocations(void) {
+	return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+#else
+long BenchmarkAllocations(void) {
+	return -1;
+}
+#endif
+
+bool ParseBenchmarkArgs(int* argc, char** argv, const char* name, char** output) {
+	bool enabled = false;
+	size_t len = strlen(name);
+	for (int i = 1; i < *argc; i++) {
+		if (strncmp(argv[i], name, len) != 0) {
+			continue;
+		}
+		if (argv[i][len] == '=') {
+			*output = argv[i] + len + 1;
+		} else if (argv[i][len] != '\0') {
+			continue;
+		}
+		enabled = true;
+		// hide it from the engine
+		for (int j = i; j < *argc - 1; j++) {
+			argv[j] = argv[j + 1];
+		}
+		(*argc)--;
+		i--;
+	}
+	return enabled;
+}
+
+double BenchmarkClock(void) {
+	// al_get_time() only starts counting once Allegro is initialized, so it can't tell how long
+	// that took; a monotonic clock available before that is used to measure from main() instead
+	struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	timespec_get(&ts, TIME_UTC);
+#endif
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+void StartBenchmark(struct Game* game, struct Benchmark* benchmark, char* output, double launch) {
+	benchmark->enabled = true;
+	benchmark->origin = al_get_time() - (BenchmarkClock() - launch);
+	benchmark->finished = false;
+	benchmark->output = output ? strdup(output) : NULL;
+	benchmark->count = 0;
+	benchmark->size = 64;
+	benchmark->stages = calloc(benchmark->size, sizeof(struct BenchmarkStage));
+	benchmark->progress = NULL;
+	benchmark->tick = 0;
+	PrintConsole(game, "Startup benchmark enabled.");
+}
+
+void StartBoardBenchmark(struct Game* game, struct Benchmark* benchmark, char* output, char* baseline) {
+	benchmark->board = true;
+	benchmark->board_output = output ? strdup(output) : NULL;
+	benchmark->baseline = baseline ? strdup(baseline) : NULL;
+	PrintConsole(game, "Board benchmark enabled.");
+}
+
+void StartStressBenchmark(struct Game* game, struct Benchmark* benchmark, char* output, char* minutes, char* speed) {
+	benchmark->stress = true;
+	benchmark->stress_output = output ? strdup(output) : NULL;
+	benchmark->stress_duration = (minutes ? strtod(minutes, NULL) : 10.0) * 60.0;
+	benchmark->stress_speed = speed ? strtod(speed, NULL) : 1.0;
+	if (benchmark->stress_speed <= 0.0) {
+		benchmark->stress_speed = 1.0;
+	}
+	PrintConsole(game, "Stress test enabled for %.1f minutes at %.1fx speed.", benchmark->stress_duration / 60.0, benchmark->stress_speed);
+}
+
+void DestroyBenchmark(struct Game* game, struct Benchmark* benchmark) {
+	free(benchmark->stages);
+	free(benchmark->output);
+	free(benchmark->board_output);
+	free(benchmark->baseline);
+	free(benchmark->stress_output);
+	benchmark->stages = NULL;
+	benchmark->output = NULL;
+	benchmark->board_output = NULL;
+	benchmark->baseline = NULL;
+	benchmark->stress_output = NULL;
+	benchmark->enabled = false;
+	benchmark->board = false;
+	benchmark->stress = false;
+}
+
+void BenchmarkStage(struct Game* game, const char* name, double start, double end) {
+	struct Benchmark* benchmark = &game->data->benchmark;
+	if (!benchmark->enabled || benchmark->finished) {
+		return;
+	}
+	if (benchmark->count == benchmark->size) {
+		benchmark->size *= 2;
+		benchmark->stages = realloc(benchmark->stages, benchmark->size * sizeof(struct BenchmarkStage));
+	}
+	struct BenchmarkStage* stage = &benchmark->stages[benchmark->count++];
+	snprintf(stage->name, sizeof(stage->name), "%s", name);
+	// reported relative to the start of main()
+	stage->start = start - benchmark->origin;
+	stage->end = end - benchmark->origin;
+}
+
+static void BenchmarkProgressTick(struct Game* game) {
+	struct Benchmark* benchmark = &game->data->benchmark;
+	char name[64];
+	snprintf(name, sizeof(name), "%s/progress/%d", benchmark->gamestate, benchmark->tick++);
+	double now = al_get_time();
+	BenchmarkStage(game, name, benchmark->last_tick, now);
+	benchmark->last_tick = now;
+	benchmark->progress(game);
+}
+
+void BenchmarkProgress(struct Game* game, const char* gamestate, void (**progress)(struct Game*)) {
+	struct Benchmark* benchmark = &game->data->benchmark;
+	if (!benchmark->enabled || benchmark->finished) {
+		return;
+	}
+	// gamestates are loaded one after another, so there's only one of them to keep track of
+	snprintf(benchmark->gamestate, sizeof(benchmark->gamestate), "%s", gamestate);
+	benchmark->progress = *progress;
+	benchmark->tick = 0;
+	benchmark->last_tick = al_get_time();
+	*progress = BenchmarkProgressTick;
+}
+
+void DeferBenchmark(struct Game* game, void (*func)(struct Game*, void*), void* data) {
+	struct Benchmark* benchmark = &game->data->benchmark;
+	if (!benchmark->enabled || benchmark->finished) {
+		return;
+	}
+	benchmark->deferred = func;
+	benchmark->deferred_data = data;
+}
+
+void FinishBenchmark(struct Game* game) {
+	struct Benchmark* benchmark = &game->data->benchmark;
+	if (!benchmark->enabled || benchmark->finished) {
+		return;
+	}
+	BenchmarkStage(game, "first_frame", benchmark->origin, al_get_time());
+	if (benchmark->deferred) {
+		ALLEGRO_BITMAP* target = al_get_target_bitmap();
+		benchmark->deferred(game, benchmark->deferred_data);
+		benchmark->deferred = NULL;
+		al_set_target_bitmap(target);
+	}
+	benchmark->finished = true;
+
+	FILE* file = stdout;
+	if (benchmark->output) {
+		file = fopen(benchmark->output, "w");
+		if (!file) {
+			PrintConsole(game, "Could not open benchmark output file: %s", benchmark->output);
+			file = stdout;
+		}
+	}
+
+	fprintf(file, "{\n\t\"game\": \"%s\",\n\t\"version\": \"%s-%s\",\n\t\"stages\": [\n", LIBSUPERDERPY_GAMENAME, LIBSUPERDERPY_GAME_VERSION, LIBSUPERDERPY_GAME_GIT_REV);
+	for (int i = 0; i < benchmark->count; i++) {
+		struct BenchmarkStage* stage = &benchmark->stages[i];
+		fprintf(file, "\t\t{\"name\": \"%s\", \"start\": %.6f, \"end\": %.6f, \"duration\": %.6f}%s\n",
+			stage->name, stage->start, stage->end, stage->end - stage->start, (i < benchmark->count - 1) ? "," : "");
+	}
+	fprintf(file, "\t]\n}\n");
+
+	if (file != stdout) {
+		fclose(file);
+	} else {
+		fflush(file);
+	}
+
+	QuitGame(game, false);
+}
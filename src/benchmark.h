@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ANIMATCH_BENCHMARK_H
+#define ANIMATCH_BENCHMARK_H
+
+#include <stdbool.h>
+
+struct Game;
+
+struct BenchmarkStage {
+	char name[64];
+	double start, end;
+};
+
+struct Benchmark {
+	bool enabled, finished;
+	char* output;
+
+	struct BenchmarkStage* stages;
+	int count, size;
+	double origin; // al_get_time() of the moment main() started, which comes before Allegro's epoch
+
+	// used to time the progress ticks of the gamestate that's currently being loaded
+	void (*progress)(struct Game*);
+	char gamestate[32];
+	int tick;
+	double last_tick;
+
+	// called right before the report gets written, so work that goes on past the first frame gets timed too
+	void (*deferred)(struct Game*, void*);
+	void* deferred_data;
+
+	// micro-benchmarks of the board logic, see gamestates/game/benchmarks.c
+	bool board;
+	char *board_output, *baseline;
+
+	// stress test of the infinite level, see gamestates/game/stress.c
+	bool stress;
+	char* stress_output;
+	double stress_duration, stress_speed;
+};
+
+bool ParseBenchmarkArgs(int* argc, char** argv, const char* name, char** output);
+double BenchmarkClock(void);
+void StartBenchmark(struct Game* game, struct Benchmark* benchmark, char* output, double launch);
+void StartBoardBenchmark(struct Game* game, struct Benchmark* benchmark, char* output, char* baseline);
+void StartStressBenchmark(struct Game* game, struct Benchmark* benchmark, char* output, char* minutes, char* speed);
+long BenchmarkAllocations(void);
+void DestroyBenchmark(struct Game* game, struct Benchmark* benchmark);
+void BenchmarkStage(struct Game* game, const char* name, double start, double end);
+void BenchmarkProgress(struct Game* game, const char* gamestate, void (**progress)(struct Game*));
+void DeferBenchmark(struct Game* game, void (*func)(struct Game*, void*), void* data);
+void FinishBenchmark(struct Game* game);
+
+#endif
@@ -81,7 +81,69 @@ void DrawBuildInfo(struct Game* game) {
 	SUPPRESS_END
 }
 
+static bool IsSameMotion(ALLEGRO_EVENT* ev, ALLEGRO_EVENT* next) {
+	if (ev->type != next->type) {
+		return false;
+	}
+	if (ev->type == ALLEGRO_EVENT_TOUCH_MOVE) {
+		return ev->touch.id == next->touch.id;
+	}
+	return ev->type == ALLEGRO_EVENT_MOUSE_AXES;
+}
+
+static bool CoalesceMotion(struct Game* game, ALLEGRO_EVENT* ev) {
+	// Touch digitizers (and some mice) report motion way more often than we draw frames.
+	// When the next queued event is the same kind of motion, the current one gets swallowed
+	// and its deltas are carried over, so only the last event of a run reaches gamestates,
+	// with deltas covering the whole run.
+	// libsuperderpy has no public way to look ahead in its event queue, so this peeks at
+	// game->_priv.event_queue directly and has to follow the engine if that ever changes.
+	struct CommonResources* data = game->data;
+	if ((ev->type != ALLEGRO_EVENT_TOUCH_MOVE) && (ev->type != ALLEGRO_EVENT_MOUSE_AXES)) {
+		return false;
+	}
+
+	bool touch = ev->type == ALLEGRO_EVENT_TOUCH_MOVE;
+	if (!data->motion.pending) {
+		data->motion.dx = 0;
+		data->motion.dy = 0;
+		data->motion.dz = 0;
+		data->motion.dw = 0;
+	}
+
+	ALLEGRO_EVENT next;
+	if (al_peek_next_event(game->_priv.event_queue, &next) && IsSameMotion(ev, &next)) {
+		if (touch) {
+			data->motion.dx += ev->touch.dx;
+			data->motion.dy += ev->touch.dy;
+		} else {
+			data->motion.dx += ev->mouse.dx;
+			data->motion.dy += ev->mouse.dy;
+			data->motion.dz += ev->mouse.dz;
+			data->motion.dw += ev->mouse.dw;
+		}
+		data->motion.pending = true;
+		return true;
+	}
+
+	if (touch) {
+		ev->touch.dx += data->motion.dx;
+		ev->touch.dy += data->motion.dy;
+	} else {
+		ev->mouse.dx += data->motion.dx;
+		ev->mouse.dy += data->motion.dy;
+		ev->mouse.dz += data->motion.dz;
+		ev->mouse.dw += data->motion.dw;
+	}
+	data->motion.pending = false;
+	return false;
+}
+
 bool GlobalEventHandler(struct Game* game, ALLEGRO_EVENT* ev) {
+	if (CoalesceMotion(game, ev)) {
+		return true;
+	}
+
 	if ((ev->type == ALLEGRO_EVENT_KEY_DOWN) && (ev->keyboard.keycode == ALLEGRO_KEY_M)) {
 		ToggleMute(game);
 	}
@@ -136,6 +198,45 @@ bool IsOnUIElement(struct Game* game, struct Character* ui, enum UI_ELEMENT elem
 	return IsOnCharacter(game, ui, x, y, true);
 }
 
+void GetBitmapEdgeProfile(struct Game* game, ALLEGRO_BITMAP* bitmap, int x, int y, int length, float alpha, int* profile) {
+	// For each of <length> rows starting at <y>, finds how far to the right of <x> the first
+	// pixel with at least <alpha> opacity is (or the distance to the edge of the bitmap).
+	// Reading pixels one by one from a video bitmap means a readback each time, so the whole
+	// region gets locked at once instead.
+	int width = al_get_bitmap_width(bitmap) - x;
+	int height = fmin(length, al_get_bitmap_height(bitmap) - y);
+	for (int i = 0; i < length; i++) {
+		profile[i] = width;
+	}
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	ALLEGRO_LOCKED_REGION* region = al_lock_bitmap_region(bitmap, x, y, width, height, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READONLY);
+	if (!region) {
+		PrintConsole(game, "Could not lock bitmap for reading its edge profile, falling back to reading it pixel by pixel.");
+		for (int i = 0; i < height; i++) {
+			for (int offset = 0; offset < width; offset++) {
+				if (al_get_pixel(bitmap, x + offset, y + i).a >= alpha) {
+					profile[i] = offset;
+					break;
+				}
+			}
+		}
+		return;
+	}
+	for (int i = 0; i < height; i++) {
+		unsigned char* row = (unsigned char*)region->data + i * region->pitch;
+		for (int offset = 0; offset < width; offset++) {
+			if (row[offset * 4 + 3] / 255.0 >= alpha) {
+				profile[i] = offset;
+				break;
+			}
+		}
+	}
+	al_unlock_bitmap(bitmap);
+}
+
 void StartTransition(struct Game* game, float x, float y) {
 	if (game->data->config.animated_transitions) {
 		EnableCompositor(game, Compositor);
@@ -168,34 +269,32 @@ void UnlockLevel(struct Game* game, int level) {
 	if (game->data->unlocked_levels + 1 == level) {
 		game->data->unlocked_levels = level;
 		game->data->last_unlocked_level = game->data->unlocked_levels;
-		char val[255] = {};
-		snprintf(val, 255, "%d", game->data->unlocked_levels);
-		SetConfigOption(game, "Animatch", "unlocked_levels", val);
+		GetLevelProgress(game, &game->data->progress, level)->unlocked = true;
+		StoreLevelProgress(game, &game->data->progress, level);
 	}
 }
 
 void RegisterScore(struct Game* game, int level, int moves, int score) {
-	char namescore[255] = {}, namemoves[255] = {};
-	snprintf(namescore, 255, "level%d-score", level);
-	snprintf(namemoves, 255, "level%d-moves", level);
+	struct LevelProgress* progress = GetLevelProgress(game, &game->data->progress, level);
+	if (!progress) {
+		return;
+	}
 
-	int s = strtol(GetConfigOptionDefault(game, namescore, "score", "0"), NULL, 0);
-	int m = strtol(GetConfigOptionDefault(game, namemoves, "moves", "99999"), NULL, 0);
+	int s = progress->score_score;
+	int m = progress->moves_moves;
 
-	char val[255] = {};
 	if ((score > s) || (score == s && moves < m)) {
-		snprintf(val, 255, "%d", score);
-		SetConfigOption(game, namescore, "score", val);
-		snprintf(val, 255, "%d", moves);
-		SetConfigOption(game, namescore, "moves", val);
+		progress->score_score = score;
+		progress->score_moves = moves;
 	}
 
 	if ((moves < m) || (moves == m && score > s)) {
-		snprintf(val, 255, "%d", score);
-		SetConfigOption(game, namemoves, "score", val);
-		snprintf(val, 255, "%d", moves);
-		SetConfigOption(game, namemoves, "moves", val);
+		progress->moves_score = score;
+		progress->moves_moves = moves;
 	}
+
+	progress->finished = true;
+	StoreLevelProgress(game, &game->data->progress, level);
 }
 
 bool LevelExists(struct Game* game, int id) {
@@ -219,16 +318,22 @@ bool LevelExists(struct Game* game, int id) {
 
 struct CommonResources* CreateGameData(struct Game* game) {
 	struct CommonResources* data = calloc(1, sizeof(struct CommonResources));
+	// Linked programs aren't cached on our side: Allegro builds ALLEGRO_SHADERs only from source
+	// and looks up their locations by itself, so warm starts rely on the driver's shader cache.
 	data->kawese_shader = CreateShader(game, GetDataFilePath(game, "shaders/vertex.glsl"), GetDataFilePath(game, "shaders/kawese.glsl"));
+	data->config.texture_cache = strtol(GetConfigOptionDefault(game, "Animatch", "texture_cache", "1"), NULL, 0);
 	char* names[] = {"silhouette/frog.webp", "silhouette/bee.webp", "silhouette/ladybug.webp", "silhouette/cat.webp", "silhouette/fish.webp"};
-	data->silhouette = al_load_bitmap(GetDataFilePath(game, names[rand() % (sizeof(names) / sizeof(names[0]))]));
+	// game->data isn't set until this returns, so the cache setting has to be passed explicitly
+	data->silhouette = LoadBitmapWithCache(game, names[rand() % (sizeof(names) / sizeof(names[0]))], data->config.texture_cache);
 
 	data->level = 0;
-	data->unlocked_levels = strtol(GetConfigOptionDefault(game, "Animatch", "unlocked_levels", "1"), NULL, 0);
+	LoadProgress(game, &data->progress);
+	data->unlocked_levels = CountUnlockedLevels(game, &data->progress);
 	data->last_unlocked_level = -1;
 	data->in_progress = false;
 
 	data->config.less_movement = strtol(GetConfigOptionDefault(game, "Animatch", "less_movement", "0"), NULL, 0);
+	data->config.fast_cascades = strtol(GetConfigOptionDefault(game, "Animatch", "fast_cascades", "0"), NULL, 0);
 	data->config.solid_background = strtol(GetConfigOptionDefault(game, "Animatch", "solid_background", "0"), NULL, 0);
 	data->config.allow_continuing = strtol(GetConfigOptionDefault(game, "Animatch", "allow_continuing", "0"), NULL, 0);
 	data->config.animated_transitions = strtol(GetConfigOptionDefault(game, "Animatch", "animated_transitions", "1"), NULL, 0);
@@ -242,5 +347,7 @@ void DestroyGameData(struct Game* game) {
 	if (game->data->transition.bmp) {
 		al_destroy_bitmap(game->data->transition.bmp);
 	}
+	DestroyProgress(game, &game->data->progress);
+	DestroyBenchmark(game, &game->data->benchmark);
 	free(game->data);
 }
@@ -21,6 +21,9 @@
 #include <defines.h>
 #include <libsuperderpy.h>
 
+#include "benchmark.h"
+#include "progress.h"
+
 enum UI_ELEMENT {
 	UI_ELEMENT_HOME,
 	UI_ELEMENT_FX,
@@ -51,11 +54,19 @@ struct CommonResources {
 	// Fill in with common data accessible from all gamestates.
 	double mouseX, mouseY;
 	bool touch;
+
+	struct {
+		bool pending;
+		float dx, dy, dz, dw;
+	} motion; // see CoalesceMotion
 	ALLEGRO_BITMAP* silhouette;
 	ALLEGRO_SHADER* kawese_shader;
 	int level, unlocked_levels, last_unlocked_level;
 	bool in_progress;
 
+	struct Progress progress;
+	struct Benchmark benchmark;
+
 	struct {
 		float progress;
 		ALLEGRO_BITMAP *bmp;
@@ -64,9 +75,11 @@ struct CommonResources {
 
 	struct {
 		bool less_movement;
+		bool fast_cascades;
 		bool solid_background;
 		bool allow_continuing;
 		bool animated_transitions;
+		bool texture_cache;
 	} config;
 };
 
@@ -78,6 +91,7 @@ bool GlobalEventHandler(struct Game* game, ALLEGRO_EVENT* ev);
 void DrawBuildInfo(struct Game* game);
 void DrawUIElement(struct Game* game, struct Character* ui, enum UI_ELEMENT element);
 bool IsOnUIElement(struct Game* game, struct Character* ui, enum UI_ELEMENT element, float x, float y);
+void GetBitmapEdgeProfile(struct Game* game, ALLEGRO_BITMAP* bitmap, int x, int y, int length, float alpha, int* profile);
 void StartTransition(struct Game* game, float x, float y);
 void ToggleAudio(struct Game* game);
 void UnlockLevel(struct Game* game, int level);
@@ -85,5 +99,6 @@ void RegisterScore(struct Game* game, int level, int moves, int score);
 bool LevelExists(struct Game* game, int id);
 
 #include "scrollingviewport.h"
+#include "texturecache.h"
 
 #endif
@@ -20,13 +20,9 @@
 
 #include "game/game.h"
 
-int Gamestate_ProgressCount = 82 + COLS * 3; // number of loading steps as reported by Gamestate_Load
-
-void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double delta) {
-	// Called 60 times per second (by default). Here you should do all your game logic.
-
-	SanityCheckLevel(game, data);
+int Gamestate_ProgressCount = 71 + MAX_COLS * 3; // number of loading steps as reported by Gamestate_Load
 
+static void Tick(struct Game* game, struct GamestateResources* data, double delta) {
 	data->counter += delta * sqrt(1.0 + data->counter_speed * data->counter_strength);
 	data->counter_speed -= delta;
 	data->counter_strength -= delta * 8;
@@ -35,11 +31,43 @@ void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double
 		data->counter_strength = 0.0;
 	}
 
-	TM_Process(data->timeline, delta);
-	UpdateParticles(game, data->particles, delta);
+	// the board runs on its own clock, which goes faster with fast cascades enabled
+	double board_delta = delta * (game->data->config.fast_cascades ? FAST_CASCADES_SPEED : 1.0);
+
+	TM_Process(data->timeline, board_delta);
+	RunQueuedTurn(game, data);
 	UpdateTween(&data->acorn_top.tween, delta);
 	UpdateTween(&data->acorn_bottom.tween, delta);
 	UpdateTween(&data->scoring, delta);
+
+	if (game->data->config.less_movement) {
+		data->scoring.pos = 1.0;
+	}
+
+	UpdateFieldAnimations(game, data, board_delta);
+
+	if (data->done) {
+		data->locked = true;
+		UpdateTween(&data->finishing, delta);
+	}
+
+	if (data->failed) {
+		data->locked = true;
+		UpdateTween(&data->failing, delta);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		UpdateTween(&data->goal_tween[i], delta);
+	}
+}
+
+static void Animate(struct Game* game, struct GamestateResources* data, double delta) {
+	// Purely cosmetic animations that the turns never look at. They don't have
+	// to be stepped in lockstep with the rules, so they're advanced once per
+	// frame instead of on every Tick.
+	double board_delta = delta * (game->data->config.fast_cascades ? FAST_CASCADES_SPEED : 1.0);
+
+	UpdateParticles(game, data->particles, delta);
 	data->snail_blink -= delta;
 
 	if (!game->data->config.less_movement) {
@@ -49,14 +77,12 @@ void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double
 			data->snail->pos = rand() % data->snail->spritesheet->frame_count;
 			data->snail->frame = &data->snail->spritesheet->frames[data->snail->pos];
 		}
-	} else {
-		data->scoring.pos = 1.0;
 	}
 
-	for (int i = 0; i < COLS; i++) {
-		UpdateTween(&data->nests[i].tween, delta);
+	for (int i = 0; i < data->cols; i++) {
+		UpdateTween(&data->nests[i].tween, board_delta);
 
-		for (int j = 0; j < ROWS; j++) {
+		for (int j = 0; j < data->rows; j++) {
 			if (IsDrawable(data->fields[i][j].type)) {
 				AnimateCharacter(game, data->fields[i][j].drawable, delta, 1.0);
 			}
@@ -65,84 +91,48 @@ void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double
 					AnimateCharacter(game, data->fields[i][j].overlay, delta, 1.0);
 				}
 			}
-			UpdateTween(&data->fields[i][j].animation.falling, delta);
-			UpdateTween(&data->fields[i][j].animation.hiding, delta);
-			UpdateTween(&data->fields[i][j].animation.swapping, delta);
-			UpdateTween(&data->fields[i][j].animation.shaking, delta);
-			UpdateTween(&data->fields[i][j].animation.hinting, delta);
-			UpdateTween(&data->fields[i][j].animation.launching, delta);
-			UpdateTween(&data->fields[i][j].animation.collecting, delta);
-
 			if (data->fields[i][j].to_highlight) {
 				data->fields[i][j].highlight += delta * 8.0;
 			} else {
 				data->fields[i][j].highlight -= delta * 2.0;
 			}
 			data->fields[i][j].highlight = Clamp(0.0, 1.0, data->fields[i][j].highlight);
-
-			if (IsSleeping(&data->fields[i][j])) {
-				continue;
-			}
-			if (!IsDrawable(data->fields[i][j].type)) {
-				continue;
-			}
-
-			if (!game->data->config.less_movement) {
-				if (data->fields[i][j].animation.blink_time) {
-					data->fields[i][j].animation.blink_time -= (int)(delta * 1000);
-					if (data->fields[i][j].animation.blink_time <= 0) {
-						data->fields[i][j].animation.blink_time = 0;
-						if (data->fields[i][j].type == FIELD_TYPE_ANIMAL) {
-							SelectSpritesheet(game, data->fields[i][j].drawable, "stand");
-						}
-					}
-				} else if (data->fields[i][j].animation.action_time) {
-					data->fields[i][j].animation.action_time -= (int)(delta * 1000);
-					if (data->fields[i][j].animation.action_time <= 0) {
-						data->fields[i][j].animation.action_time = 0;
-						if (data->fields[i][j].type == FIELD_TYPE_ANIMAL) {
-							SelectSpritesheet(game, data->fields[i][j].drawable, "stand");
-						}
-					}
-				} else {
-					data->fields[i][j].animation.time_to_action -= (int)(delta * 1000);
-					data->fields[i][j].animation.time_to_blink -= (int)(delta * 1000);
-
-					if (data->fields[i][j].animation.time_to_action <= 0) {
-						data->fields[i][j].animation.time_to_action = rand() % 250000 + 500000;
-						data->fields[i][j].animation.action_time = rand() % 2000 + 1000;
-						if (data->fields[i][j].type == FIELD_TYPE_ANIMAL) {
-							SelectSpritesheet(game, data->fields[i][j].drawable, ANIMAL_ACTIONS[data->fields[i][j].data.animal.type].names[rand() % ANIMAL_ACTIONS[data->fields[i][j].data.animal.type].actions]);
-						}
-					}
-
-					if (data->fields[i][j].animation.time_to_blink <= 0) {
-						if (strcmp(data->fields[i][j].drawable->spritesheet->name, "stand") == 0) {
-							if (data->fields[i][j].type == FIELD_TYPE_ANIMAL) {
-								SelectSpritesheet(game, data->fields[i][j].drawable, "blink");
-							}
-							data->fields[i][j].animation.time_to_blink = rand() % 100000 + 200000;
-							data->fields[i][j].animation.blink_time = rand() % 400 + 100;
-						}
-					}
-				}
-			}
 		}
 	}
 
-	if (data->done) {
-		data->locked = true;
-		UpdateTween(&data->finishing, delta);
-	}
+	UpdateIdleAnimations(game, data, delta);
+}
 
-	if (data->failed) {
-		data->locked = true;
-		UpdateTween(&data->failing, delta);
-	}
+void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double delta) {
+	// Called once per frame. The rules are stepped at a fixed rate below, see LOGIC_STEP.
 
-	for (int i = 0; i < 3; i++) {
-		UpdateTween(&data->goal_tween[i], delta);
+	SanityCheckLevel(game, data);
+	PollLevelVerification(game, data);
+
+	int max_steps = LOGIC_MAX_STEPS;
+	if (game->data->benchmark.stress) {
+		// compress the animations so the turns go by faster
+		delta *= game->data->benchmark.stress_speed;
+		max_steps = (int)ceil(max_steps * game->data->benchmark.stress_speed);
+	}
+
+	// The simulation always advances in steps of LOGIC_STEP, no matter how long
+	// the frames are, so the outcome of a game doesn't depend on the frame rate.
+	// Whatever is left over is carried to the next frame and used by DrawField
+	// to bring the running tweens forward. After a long stall the backlog is
+	// dropped instead of being caught up with all at once.
+	data->logic.remainder += delta;
+	int steps = 0;
+	while (data->logic.remainder >= LOGIC_STEP) {
+		if (steps == max_steps) {
+			data->logic.remainder = 0.0;
+			break;
+		}
+		Tick(game, data, LOGIC_STEP);
+		data->logic.remainder -= LOGIC_STEP;
+		steps++;
 	}
+	Animate(game, data, steps * LOGIC_STEP);
 
 	if (data->restart_hover) {
 		data->restart_btn->tint = al_map_rgb_f(1.5, 1.5, 1.5);
@@ -150,20 +140,24 @@ void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double
 		data->restart_btn->tint = al_map_rgb_f(1.0, 1.0, 1.0);
 	}
 
+	if (game->data->benchmark.stress) {
+		UpdateStressTest(game, data);
+	}
+
 	DrawDebugInterface(game, data);
 }
 
 void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 	// Called as soon as possible, but no sooner than next Gamestate_Logic call.
 	// Draw everything to the screen here.
-	int offsetY = (int)((game->viewport.height - (ROWS * 90)) / 2.0);
+	int offsetY = data->cell.y;
 
 	al_set_target_bitmap(data->board);
 	ClearToColor(game, al_map_rgba(0, 0, 0, 0));
 	al_set_clipping_rectangle(0, offsetY, game->viewport.width, game->viewport.height - offsetY * 2);
 	al_hold_bitmap_drawing(true);
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			bool hovered = IsSameID(data->hovered, (struct FieldID){i, j});
 			ALLEGRO_COLOR color = al_map_rgba(222, 222, 222, 222);
 			if (data->locked || game->data->touch || !hovered) {
@@ -171,9 +165,9 @@ void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 			}
 			color = InterpolateColor(color, al_map_rgba(240, 240, 240, 240), data->fields[i][j].highlight);
 			if (data->fields[i][j].type != FIELD_TYPE_DISABLED) {
-				ALLEGRO_BITMAP* bmp = data->field_bgs[(j * ROWS + i + j % 2) % 4];
+				ALLEGRO_BITMAP* bmp = data->field_bgs[(i + j % 2) % 4];
 				al_draw_tinted_scaled_bitmap(bmp, color, 0, 0, al_get_bitmap_width(bmp), al_get_bitmap_height(bmp),
-					i * 90 + 1, j * 90 + offsetY + 1, 90 - 2, 90 - 2, 0);
+					data->cell.x + i * data->cell.size + 1, offsetY + j * data->cell.size + 1, data->cell.size - 2, data->cell.size - 2, 0);
 			}
 		}
 	}
@@ -182,8 +176,8 @@ void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 	bool show_nests = data->level.field_types[FIELD_TYPE_FREEFALL];
 
 	al_use_shader(data->desaturate_shader);
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			DrawField(game, data, data->fields[i][j].id);
 			if (data->fields[i][j].type == FIELD_TYPE_FREEFALL) {
 				show_nests = true;
@@ -191,8 +185,8 @@ void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 		}
 	}
 	al_reset_clipping_rectangle();
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			DrawOverlay(game, data, data->fields[i][j].id);
 		}
 	}
@@ -215,15 +209,15 @@ void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 	al_use_shader(NULL);
 
 	if (show_nests) {
-		for (int i = 0; i < COLS; i++) {
-			int j = ROWS - 1;
+		for (int i = 0; i < data->cols; i++) {
+			int j = data->rows - 1;
 			while (j > 0 && data->fields[i][j].type == FIELD_TYPE_DISABLED) {
 				j--;
 			}
 			if (data->fields[i][j].type != FIELD_TYPE_DISABLED) {
-				SetCharacterPosition(game, data->nests[i].character, (i + 0.5) * (game->viewport.width / (float)COLS), offsetY + (j + 1.175) * (game->viewport.height - offsetY * 2) / (float)ROWS, sin(GetTweenValue(&data->nests[i].tween) * 2.5 * ALLEGRO_PI) / 12.0);
-				data->nests[i].character->scaleX = 0.8;
-				data->nests[i].character->scaleY = 0.8;
+				SetCharacterPosition(game, data->nests[i].character, data->cell.x + (i + 0.5) * data->cell.size, offsetY + (j + 1.175) * data->cell.size, sin(GetTweenValue(&data->nests[i].tween) * 2.5 * ALLEGRO_PI) / 12.0);
+				data->nests[i].character->scaleX = 0.8 * data->cell.size / FIELD_SIZE;
+				data->nests[i].character->scaleY = 0.8 * data->cell.size / FIELD_SIZE;
 				DrawCharacter(game, data->nests[i].character);
 			}
 		}
@@ -312,8 +306,8 @@ void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 	DrawParticles(game, data->particles);
 
 	al_use_shader(data->desaturate_shader);
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			if (IsDrawable(data->fields[i][j].type) && GetTweenPosition(&data->fields[i][j].animation.launching) < 1.0) {
 				al_set_shader_bool("enabled", IsSleeping(&data->fields[i][j]));
 				DrawCharacter(game, data->fields[i][j].drawable);
@@ -388,13 +382,13 @@ void Gamestate_ProcessEvent(struct Game* game, struct GamestateResources* data,
 	}
 
 	if ((ev->type == ALLEGRO_EVENT_MOUSE_AXES) || (ev->type == ALLEGRO_EVENT_TOUCH_MOVE) || (ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_DOWN) || (ev->type == ALLEGRO_EVENT_TOUCH_BEGIN)) {
-		if (!IsOnCharacter(game, data->restart_btn, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height, true)) {
+		if (!IsOnHitTarget(game, data, HIT_TARGET_RESTART, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height)) {
 			data->restart_hover = false;
 		}
 	}
 
 	if ((ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_DOWN) || (ev->type == ALLEGRO_EVENT_TOUCH_BEGIN)) {
-		data->restart_hover = IsOnCharacter(game, data->restart_btn, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height, true);
+		data->restart_hover = IsOnHitTarget(game, data, HIT_TARGET_RESTART, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height);
 
 		if (game->data->config.allow_continuing && data->failed) {
 			int x1 = 120, x2 = 240, y1 = 918 * GetTweenValue(&data->failing) - 67, y2 = 918 * GetTweenValue(&data->failing) - 22;
@@ -426,18 +420,18 @@ void Gamestate_ProcessEvent(struct Game* game, struct GamestateResources* data,
 			return;
 		}
 
-		if (IsOnCharacter(game, data->beetle, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height, true)) {
+		if (IsOnHitTarget(game, data, HIT_TARGET_BEETLE, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height)) {
 			data->menu = !data->menu;
 			return;
 		}
 		if (data->menu) {
-			if (IsOnUIElement(game, data->ui, UI_ELEMENT_HINT, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height)) {
+			if (IsOnHitTarget(game, data, HIT_TARGET_HINT, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height)) {
 				data->menu = false;
 				ShowHint(game, data);
 				return;
 			}
 
-			if (IsOnUIElement(game, data->ui, UI_ELEMENT_HOME, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height)) {
+			if (IsOnHitTarget(game, data, HIT_TARGET_HOME, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height)) {
 				StartTransition(game, 0.5, 0.5);
 				ChangeCurrentGamestate(game, "menu");
 				return;
@@ -449,35 +443,42 @@ void Gamestate_ProcessEvent(struct Game* game, struct GamestateResources* data,
 	}
 
 	if ((ev->type == ALLEGRO_EVENT_MOUSE_AXES) || (ev->type == ALLEGRO_EVENT_TOUCH_MOVE) || (ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_DOWN) || (ev->type == ALLEGRO_EVENT_TOUCH_BEGIN)) {
-		int offsetY = (int)((game->viewport.height - (ROWS * 90)) / 2.0);
-		data->hovered.i = (int)(game->data->mouseX * game->viewport.width / 90);
-		data->hovered.j = (int)((game->data->mouseY * game->viewport.height - offsetY) / 90);
-		if ((data->hovered.i < 0) || (data->hovered.j < 0) || (data->hovered.i >= COLS) || (data->hovered.j >= ROWS) || (game->data->mouseY * game->viewport.height <= offsetY) || (game->data->mouseX == 0.0)) {
-			data->hovered.i = -1;
-			data->hovered.j = -1;
+		data->hovered = GetFieldAt(game, data, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height);
+		if (game->data->mouseX == 0.0) {
+			data->hovered = (struct FieldID){-1, -1};
 		}
 	}
 
 	if ((ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_DOWN) || (ev->type == ALLEGRO_EVENT_TOUCH_BEGIN)) {
-		if (IsOnCharacter(game, data->acorn_top.character, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height, true)) {
+		if (IsOnHitTarget(game, data, HIT_TARGET_ACORN_TOP, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height)) {
 			data->acorn_top.tween = Tween(game, fmod(GetTweenValue(&data->acorn_top.tween), 2 * ALLEGRO_PI), ALLEGRO_PI * 8, TWEEN_STYLE_QUADRATIC_OUT, 1.5);
 		}
-		if (IsOnCharacter(game, data->acorn_bottom.character, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height, true)) {
+		if (IsOnHitTarget(game, data, HIT_TARGET_ACORN_BOTTOM, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height)) {
 			data->acorn_bottom.tween = Tween(game, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, 0.75);
 		}
 	}
 
-	if (data->locked) {
-		return;
+	if ((ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_DOWN) || (ev->type == ALLEGRO_EVENT_TOUCH_BEGIN)) {
+		if (!data->locked || data->turn.running) {
+			data->current = data->hovered;
+			data->clicked = true;
+		}
 	}
 
-	if ((ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_DOWN) || (ev->type == ALLEGRO_EVENT_TOUCH_BEGIN)) {
-		data->current = data->hovered;
-		data->clicked = true;
+	if (data->locked) {
+		if (data->turn.running) {
+			if (((ev->type == ALLEGRO_EVENT_MOUSE_AXES) || (ev->type == ALLEGRO_EVENT_TOUCH_MOVE)) && (data->clicked)) {
+				QueueTurn(game, data, data->current, GetSwipeTarget(game, data, data->current, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height));
+			}
+			if ((ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_UP) || (ev->type == ALLEGRO_EVENT_TOUCH_END)) {
+				data->clicked = false;
+			}
+		}
+		return;
 	}
 
 	if (((ev->type == ALLEGRO_EVENT_MOUSE_AXES) || (ev->type == ALLEGRO_EVENT_TOUCH_MOVE)) && (data->clicked)) {
-		Turn(game, data, data->current, data->hovered);
+		Turn(game, data, data->current, GetSwipeTarget(game, data, data->current, game->data->mouseX * game->viewport.width, game->data->mouseY * game->viewport.height));
 	}
 
 	if ((ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_UP) || (ev->type == ALLEGRO_EVENT_TOUCH_END)) {
@@ -489,15 +490,7 @@ void Gamestate_ProcessEvent(struct Game* game, struct GamestateResources* data,
 	}
 }
 
-void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
-	// Called once, when the gamestate library is being loaded.
-	// Good place for allocating memory, loading bitmaps etc.
-	//
-	// NOTE: Depending on engine configuration, this may be called from a separate thread.
-	// Unless you're sure what you're doing, avoid using drawing calls and other things that
-	// require main OpenGL context.
-
-	struct GamestateResources* data = calloc(1, sizeof(struct GamestateResources));
+static void LoadCharacters(struct Game* game, struct GamestateResources* data, void (*progress)(struct Game*)) {
 	for (size_t i = 0; i < sizeof(ANIMALS) / sizeof(ANIMALS[0]); i++) {
 		data->animal_archetypes[i] = CreateCharacter(game, StrToLower(game, ANIMALS[i]));
 		RegisterSpritesheet(game, data->animal_archetypes[i], "stand");
@@ -549,35 +542,14 @@ void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
 		LoadSpritesheets(game, data->special_archetypes[i], progress);
 		SelectSpritesheet(game, data->special_archetypes[i], SPECIAL_ACTIONS[i].names[SPECIAL_ACTIONS[i].actions - 1]);
 	}
+	ResolveSpritesheets(game, data);
 
-	data->bg = al_load_bitmap(GetDataFilePath(game, "bg.webp"));
-	progress(game);
-
-	data->leaf = al_load_bitmap(GetDataFilePath(game, "leaf.webp"));
-	progress(game);
-
-	data->frame = al_load_bitmap(GetDataFilePath(game, "frame_small.webp"));
-	progress(game);
-
-	data->frame_bg = al_load_bitmap(GetDataFilePath(game, "frame_small_bg.webp"));
-	progress(game);
-
+	// their bitmaps are streamed, see StartLoadingAssets
 	data->restart_btn = CreateCharacter(game, "restart_btn");
-	data->restart = al_load_bitmap(GetDataFilePath(game, "przycisk_do_tylu_on.webp"));
-	RegisterSpritesheetFromBitmap(game, data->restart_btn, "restart", data->restart);
-	LoadSpritesheets(game, data->restart_btn, progress);
-
 	data->cloud_goal = CreateCharacter(game, "cloud_goal");
-	data->cloud_goal_bmp = al_load_bitmap(GetDataFilePath(game, "cloud_goal.webp"));
-	RegisterSpritesheetFromBitmap(game, data->cloud_goal, "cloud_goal", data->cloud_goal_bmp);
-	LoadSpritesheets(game, data->cloud_goal, progress);
-
 	data->animals_goal = CreateCharacter(game, "animals_goal");
-	data->animals_goal_bmp = al_load_bitmap(GetDataFilePath(game, "animals_goal.webp"));
-	RegisterSpritesheetFromBitmap(game, data->animals_goal, "animals_goal", data->animals_goal_bmp);
-	LoadSpritesheets(game, data->animals_goal, progress);
 
-	for (int i = 0; i < COLS; i++) {
+	for (int i = 0; i < MAX_COLS; i++) {
 		data->nests[i].character = CreateCharacter(game, "nest");
 		RegisterSpritesheet(game, data->nests[i].character, "nest1");
 		RegisterSpritesheet(game, data->nests[i].character, "nest2");
@@ -590,8 +562,156 @@ void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
 		data->nests[i].tween = StaticTween(game, 0.0);
 	}
 
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	data->font = al_load_font(GetDataFilePath(game, "fonts/Caroni.ttf"), 35, 0);
+	progress(game);
+	data->font_small = al_load_font(GetDataFilePath(game, "fonts/Caroni.ttf"), 24, 0);
+	progress(game);
+	data->font_num_small = al_load_font(GetDataFilePath(game, "fonts/Brizel.ttf"), 42, 0);
+	progress(game);
+	data->font_num_medium = al_load_font(GetDataFilePath(game, "fonts/Brizel.ttf"), 55, 0);
+	progress(game);
+	data->font_num_big = al_load_font(GetDataFilePath(game, "fonts/Brizel.ttf"), 88, 0);
+	progress(game);
+}
+
+static void NoProgress(struct Game* game) {}
+
+static void QueueAssetBitmap(struct Game* game, struct GamestateResources* data, const char* name, ALLEGRO_BITMAP** bitmap) {
+	// paths are resolved here, as engine helpers can't be used from the loading thread
+	data->assets.bitmaps[data->assets.count].name = name;
+	data->assets.bitmaps[data->assets.count].path = strdup(GetDataFilePath(game, name));
+	data->assets.bitmaps[data->assets.count].bitmap = bitmap;
+	data->assets.count++;
+}
+
+static void DecodeAssetBitmaps(struct GamestateResources* data) {
+	data->assets.start = al_get_time();
+	for (int i = 0; i < data->assets.count; i++) {
+		*data->assets.bitmaps[i].bitmap = DecodeCachedBitmap(data->assets.bitmaps[i].path, data->assets.bitmaps[i].name, data->assets.cache_enabled);
+	}
+	data->assets.end = al_get_time();
+}
+
+#ifndef __EMSCRIPTEN__
+static void* AssetLoadingThread(ALLEGRO_THREAD* thread, void* arg) {
+	struct GamestateResources* data = arg;
+	// Bitmap flags and the file interface are per-thread in Allegro. The bitmaps are
+	// created as plain memory bitmaps, so the engine's al_convert_memory_bitmaps calls
+	// can't pick them up halfway through; WaitForAssets converts them after the join.
+	// Files have to be opened the same way as on the main thread (e.g. from the APK on Android).
+	al_set_new_bitmap_flags(data->assets.bitmap_flags);
+	al_set_new_file_interface(data->assets.file_interface);
+	DecodeAssetBitmaps(data);
+	return NULL;
+}
+#endif
+
+static void StartLoadingAssets(struct Game* game, struct GamestateResources* data) {
+	// The largest bitmaps get decoded in the background while the menu is shown. The thread
+	// does nothing but file I/O and decoding into memory bitmaps: the engine isn't thread-safe,
+	// so everything that touches it is done either here or in WaitForAssets.
+	data->assets.count = 0;
+	data->assets.cache_enabled = game->data->config.texture_cache;
+	QueueAssetBitmap(game, data, "bg.webp", &data->bg);
+	QueueAssetBitmap(game, data, "leaf.webp", &data->leaf);
+	QueueAssetBitmap(game, data, "frame_small.webp", &data->frame);
+	QueueAssetBitmap(game, data, "frame_small_bg.webp", &data->frame_bg);
+	QueueAssetBitmap(game, data, "przycisk_do_tylu_on.webp", &data->restart);
+	QueueAssetBitmap(game, data, "cloud_goal.webp", &data->cloud_goal_bmp);
+	QueueAssetBitmap(game, data, "animals_goal.webp", &data->animals_goal_bmp);
+	QueueAssetBitmap(game, data, "kwadrat1.webp", &data->field_bgs[0]);
+	QueueAssetBitmap(game, data, "kwadrat2.webp", &data->field_bgs[1]);
+	QueueAssetBitmap(game, data, "kwadrat3.webp", &data->field_bgs[2]);
+	QueueAssetBitmap(game, data, "kwadrat4.webp", &data->field_bgs[3]);
+
+#ifdef __EMSCRIPTEN__
+	DecodeAssetBitmaps(data);
+#else
+	data->assets.bitmap_flags = (al_get_new_bitmap_flags() & ~ALLEGRO_VIDEO_BITMAP) | ALLEGRO_MEMORY_BITMAP;
+	data->assets.file_interface = al_get_new_file_interface();
+	data->assets.thread = al_create_thread(AssetLoadingThread, data);
+	if (data->assets.thread) {
+		al_start_thread(data->assets.thread);
+	} else {
+		DecodeAssetBitmaps(data);
+	}
+#endif
+}
+
+static void JoinAssetLoading(struct Game* game, struct GamestateResources* data) {
+	if (data->assets.thread) {
+		double start = al_get_time();
+		al_join_thread(data->assets.thread, NULL);
+		al_destroy_thread(data->assets.thread);
+		data->assets.thread = NULL;
+		PrintConsole(game, "Waited %.3fs for game assets.", al_get_time() - start);
+	}
+	for (int i = 0; i < data->assets.count; i++) {
+		free(data->assets.bitmaps[i].path);
+		data->assets.bitmaps[i].path = NULL;
+	}
+}
+
+static void WaitForAssets(struct Game* game, struct GamestateResources* data) {
+	if (data->field_bgs_bmp) {
+		return;
+	}
+	double start = al_get_time();
+	JoinAssetLoading(game, data);
+	BenchmarkStage(game, "game/AssetLoadingThread", data->assets.start, data->assets.end);
+	for (int i = 0; i < data->assets.count; i++) {
+		if (*data->assets.bitmaps[i].bitmap) {
+			al_convert_bitmap(*data->assets.bitmaps[i].bitmap);
+		}
+	}
+
+	RegisterSpritesheetFromBitmap(game, data->restart_btn, "restart", data->restart);
+	LoadSpritesheets(game, data->restart_btn, NoProgress);
+	RegisterSpritesheetFromBitmap(game, data->cloud_goal, "cloud_goal", data->cloud_goal_bmp);
+	LoadSpritesheets(game, data->cloud_goal, NoProgress);
+	RegisterSpritesheetFromBitmap(game, data->animals_goal, "animals_goal", data->animals_goal_bmp);
+	LoadSpritesheets(game, data->animals_goal, NoProgress);
+
+	data->field_bgs_bmp = al_create_bitmap(88 * 4, 88);
+	al_set_target_bitmap(data->field_bgs_bmp);
+	al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+	for (int i = 0; i < 4; i++) {
+		al_draw_bitmap(data->field_bgs[i], i * 88, 0, 0);
+		al_destroy_bitmap(data->field_bgs[i]);
+		data->field_bgs[i] = al_create_sub_bitmap(data->field_bgs_bmp, i * 88, 0, 88, 88);
+	}
+
+	double blur = al_get_time();
+	UpdateBlur(game, data);
+	BenchmarkStage(game, "game/UpdateBlur", blur, al_get_time());
+	BenchmarkStage(game, "game/WaitForAssets", start, al_get_time());
+}
+
+static void FinishBenchmarkedAssets(struct Game* game, void* data) {
+	// the startup benchmark ends at the menu's first frame, but assets keep streaming past it
+	WaitForAssets(game, data);
+}
+
+void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
+	// Called once, when the gamestate library is being loaded.
+	// Good place for allocating memory, loading bitmaps etc.
+	//
+	// NOTE: Depending on engine configuration, this may be called from a separate thread.
+	// Unless you're sure what you're doing, avoid using drawing calls and other things that
+	// require main OpenGL context.
+	//
+	// The largest bitmaps are decoded in the background while the menu is shown,
+	// see StartLoadingAssets.
+
+	double start = al_get_time();
+	BenchmarkProgress(game, "game", &progress);
+
+	struct GamestateResources* data = calloc(1, sizeof(struct GamestateResources));
+	data->cols = data->level.cols = DEFAULT_COLS;
+	data->rows = data->level.rows = DEFAULT_ROWS;
+	data->random = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+	for (int i = 0; i < MAX_COLS; i++) {
+		for (int j = 0; j < MAX_ROWS; j++) {
 			data->fields[i][j].drawable = CreateCharacter(game, NULL);
 			data->fields[i][j].drawable->shared = true;
 			data->fields[i][j].overlay = CreateCharacter(game, NULL);
@@ -604,17 +724,13 @@ void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
 			data->fields[i][j].match_mark = 0;
 			data->fields[i][j].locked = true;
 			data->fields[i][j].animation.super = (struct FieldID){-1, -1};
+			if (i >= data->cols || j >= data->rows) {
+				data->fields[i][j].type = FIELD_TYPE_DISABLED;
+			}
+			UpdateFieldHash(game, data, &data->fields[i][j]);
 		}
 	}
-	progress(game);
-
-	data->field_bgs[0] = al_load_bitmap(GetDataFilePath(game, "kwadrat1.webp"));
-	progress(game);
-	data->field_bgs[1] = al_load_bitmap(GetDataFilePath(game, "kwadrat2.webp"));
-	progress(game);
-	data->field_bgs[2] = al_load_bitmap(GetDataFilePath(game, "kwadrat3.webp"));
-	progress(game);
-	data->field_bgs[3] = al_load_bitmap(GetDataFilePath(game, "kwadrat4.webp"));
+	UpdateLayout(game, data);
 	progress(game);
 
 	data->lowres_scene_blur = al_create_bitmap(game->viewport.width / BLUR_DIVIDER, game->viewport.height / BLUR_DIVIDER);
@@ -626,41 +742,26 @@ void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
 	data->desaturate_shader = CreateShader(game, GetDataFilePath(game, "shaders/vertex.glsl"), GetDataFilePath(game, "shaders/desaturate.glsl"));
 	progress(game);
 
-	data->font = al_load_font(GetDataFilePath(game, "fonts/Caroni.ttf"), 35, 0);
-	progress(game);
-	data->font_small = al_load_font(GetDataFilePath(game, "fonts/Caroni.ttf"), 24, 0);
-	progress(game);
-	data->font_num_small = al_load_font(GetDataFilePath(game, "fonts/Brizel.ttf"), 42, 0);
-	progress(game);
-	data->font_num_medium = al_load_font(GetDataFilePath(game, "fonts/Brizel.ttf"), 55, 0);
-	progress(game);
-	data->font_num_big = al_load_font(GetDataFilePath(game, "fonts/Brizel.ttf"), 88, 0);
-	progress(game);
-
 	data->timeline = TM_Init(game, data, "timeline");
 
-	data->particles = CreateParticleBucket(game, 4096, true);
+	data->particles = CreateParticleBucket(game, MAX_PARTICLES, true);
 
-	return data;
-}
-
-void Gamestate_PostLoad(struct Game* game, struct GamestateResources* data) {
-	data->field_bgs_bmp = al_create_bitmap(88 * 4, 88);
-	al_set_target_bitmap(data->field_bgs_bmp);
-	al_clear_to_color(al_map_rgba(0, 0, 0, 0));
-	for (int i = 0; i < 4; i++) {
-		al_draw_bitmap(data->field_bgs[i], i * 88, 0, 0);
-		al_destroy_bitmap(data->field_bgs[i]);
-		data->field_bgs[i] = al_create_sub_bitmap(data->field_bgs_bmp, i * 88, 0, 88, 88);
-	}
+	StartLoadingAssets(game, data);
+	LoadCharacters(game, data, progress);
+	DeferBenchmark(game, FinishBenchmarkedAssets, data);
 
-	UpdateBlur(game, data);
+	BenchmarkStage(game, "game/Gamestate_Load", start, al_get_time());
+	return data;
 }
 
 void Gamestate_Unload(struct Game* game, struct GamestateResources* data) {
 	// Called when the gamestate library is being unloaded.
 	// Good place for freeing all allocated memory and resources.
+	JoinAssetLoading(game, data);
+	StopLevelVerification(game, data);
 	DestroyParticleBucket(game, data->particles);
+	DestroyStressTest(game, data);
+	DestroyHitGrid(game, data);
 	DestroyCharacter(game, data->leaves);
 	DestroyCharacter(game, data->ui);
 	DestroyCharacter(game, data->beetle);
@@ -670,9 +771,9 @@ void Gamestate_Unload(struct Game* game, struct GamestateResources* data) {
 	DestroyCharacter(game, data->restart_btn);
 	DestroyCharacter(game, data->cloud_goal);
 	DestroyCharacter(game, data->animals_goal);
-	for (int i = 0; i < COLS; i++) {
+	for (int i = 0; i < MAX_COLS; i++) {
 		DestroyCharacter(game, data->nests[i].character);
-		for (int j = 0; j < ROWS; j++) {
+		for (int j = 0; j < MAX_ROWS; j++) {
 			DestroyCharacter(game, data->fields[i][j].drawable);
 			DestroyCharacter(game, data->fields[i][j].overlay);
 		}
@@ -708,6 +809,8 @@ void Gamestate_Unload(struct Game* game, struct GamestateResources* data) {
 void Gamestate_Start(struct Game* game, struct GamestateResources* data) {
 	// Called when this gamestate gets control. Good place for initializing state,
 	// playing music etc.
+	WaitForAssets(game, data);
+
 	game->data->last_unlocked_level = -1;
 	game->data->in_progress = true;
 
@@ -736,6 +839,13 @@ void Gamestate_Start(struct Game* game, struct GamestateResources* data) {
 	} else {
 		game->data->level = data->level.id;
 	}
+
+	if (game->data->benchmark.board) {
+		RunBoardBenchmark(game, data);
+	}
+	if (game->data->benchmark.stress) {
+		StartStressTest(game, data);
+	}
 }
 
 void Gamestate_Stop(struct Game* game, struct GamestateResources* data) {
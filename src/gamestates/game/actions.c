@@ -33,7 +33,8 @@ void Turn(struct Game* game, struct GamestateResources* data, struct FieldID one
 	data->clicked = false;
 
 	if (!AreSwappable(game, data, one, two)) {
-		GetField(game, data, one)->animation.shaking = Tween(game, 0.0, 1.0, TWEEN_STYLE_SINE_OUT, SHAKING_TIME);
+		struct Field* field = GetField(game, data, one);
+		StartFieldTween(game, data, field, &field->animation.shaking, 0.0, 1.0, TWEEN_STYLE_SINE_OUT, SHAKING_TIME);
 		return;
 	}
 
@@ -45,38 +46,59 @@ void Turn(struct Game* game, struct GamestateResources* data, struct FieldID one
 	}
 }
 
+static bool WillBeSwappable(struct GamestateResources* data, struct FieldID id) {
+	struct SimField* field = &data->turn.after.fields[id.i][id.j];
+	return (field->type == FIELD_TYPE_ANIMAL && !field->sleeping) || (field->type == FIELD_TYPE_COLLECTIBLE);
+}
+
+void QueueTurn(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two) {
+	// The board is locked while a turn is being shown, but its outcome is already
+	// predicted (see turn.c), so swaps made in the meantime can be checked against the
+	// board it's going to settle at. Only the latest one is kept.
+	if (!IsValidID(one) || !IsValidID(two) || !IsValidMove(one, two)) {
+		return;
+	}
+	data->clicked = false;
+	bool last = !data->infinite && data->moves == data->moves_goal;
+	if (data->turn.finishes || last || !WillBeSwappable(data, one) || !WillBeSwappable(data, two)) {
+		return;
+	}
+	PrintConsole(game, "queued swap %dx%d with %dx%d", one.i, one.j, two.i, two.j);
+	data->queued.one = one;
+	data->queued.two = two;
+	data->queued.valid = true;
+}
+
+void RunQueuedTurn(struct Game* game, struct GamestateResources* data) {
+	if (!data->queued.valid || data->locked) {
+		return;
+	}
+	data->queued.valid = false;
+	if (data->done || data->failed || data->menu) {
+		return;
+	}
+	Turn(game, data, data->queued.one, data->queued.two);
+}
+
 bool ShowHint(struct Game* game, struct GamestateResources* data) {
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
-			struct FieldID id = {.i = i, .j = j};
-			if (CanBeMatched(game, data, id)) {
-				GetField(game, data, id)->animation.hinting = Tween(game, 0.0, 1.0, TWEEN_STYLE_SINE_IN_OUT, HINT_TIME);
-				return true;
-			}
-		}
+	struct Move move;
+	if (!FindBestMove(game, data, SEARCH_DEPTH, SEARCH_NODES, SEARCH_BUDGET, &move)) {
+		return false;
 	}
-	return false;
+	struct Field* field = GetField(game, data, move.one);
+	StartFieldTween(game, data, field, &field->animation.hinting, 0.0, 1.0, TWEEN_STYLE_SINE_IN_OUT, HINT_TIME);
+	return true;
 }
 
 bool AutoMove(struct Game* game, struct GamestateResources* data) {
 	if (data->locked) {
 		return false;
 	}
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
-			struct FieldID id = {.i = i, .j = j};
-			struct FieldID (*callbacks[])(struct FieldID) = {ToLeft, ToRight, ToTop, ToBottom};
-
-			for (int q = 0; q < 4; q++) {
-				if (IsValidMove(id, callbacks[q](id))) {
-					if (WillMatch(game, data, id, callbacks[q](id))) {
-						data->moves++;
-						StartSwapping(game, data, id, callbacks[q](id));
-						return true;
-					}
-				}
-			}
-		}
+	struct Move move;
+	if (!FindBestMove(game, data, SEARCH_DEPTH, SEARCH_NODES, SEARCH_BUDGET, &move)) {
+		return false;
 	}
-	return false;
+	data->moves++;
+	StartSwapping(game, data, move.one, move.two);
+	return true;
 }
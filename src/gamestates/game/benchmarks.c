@@ -0,0 +1,649 @@
+/*! \file benchmarks.c
+ *  \brief Micro-benchmarks of the board logic.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * When started with --benchmark-board[=file], the game runs the core board
+ * operations on every level from data/levels and on a couple of random fills,
+ * then quits dumping the time (and, when built with ANIMATCH_COUNT_ALLOCATIONS,
+ * the number of heap allocations) per single call as JSON. Passing a previous
+ * report with --benchmark-baseline=file marks everything that got slower.
+ *
+ * The board is restored from a snapshot before every measurement. Operations
+ * that change it are timed one call at a time; the cheap ones that only look
+ * at it are run in batches, as reading the clock would dominate otherwise.
+ *
+ * Every board is also used to check that GenerateField still draws its fields
+ * from the same distribution as the reroll loops it replaced. A copy of those
+ * loops is kept below as a reference; both generators fill every cell of the
+ * board many times over with different seeds and the frequencies of their
+ * outcomes are compared. Differences too big to be noise count as regressions.
+ */
+
+#define BENCHMARK_REPEATS 64 // measurements per operation and board
+#define BENCHMARK_ROUNDS 16 // passes over the board in a single batched measurement
+#define BENCHMARK_LEVEL_ID 9999 // scratch level written by the StoreLevel benchmark
+#define BENCHMARK_TOLERANCE 0.1 // relative slowdown reported as a regression
+#define GENERATOR_SEEDS 64 // passes over the board per generator in the distribution check
+#define GENERATOR_ATTEMPTS 10000 // rerolls after which the reference generator is considered stuck
+#define GENERATOR_TOLERANCE 5.0 // z-score of a difference in outcome frequency reported as a mismatch
+#define GENERATOR_BINS (1 + COLLECTIBLE_TYPES + ANIMAL_TYPES * 3)
+
+struct BoardSnapshot {
+	struct Field fields[MAX_COLS][MAX_ROWS];
+	int cols, rows;
+	struct Level level;
+	struct Goal goals[3];
+	int requirements[GOAL_TYPES];
+	int moves, moves_goal, score;
+	bool infinite;
+	uint64_t hash;
+	struct FieldCounts counts;
+};
+
+struct BoardBenchmarkResult {
+	long ops, allocs;
+	double time;
+	double baseline_ns, baseline_allocs;
+};
+
+struct GeneratorCheckResult {
+	long samples, skipped;
+	double max_z;
+};
+
+static void TakeBoardSnapshot(struct Game* game, struct GamestateResources* data, struct BoardSnapshot* snapshot) {
+	memcpy(snapshot->fields, data->fields, sizeof(data->fields));
+	snapshot->cols = data->cols;
+	snapshot->rows = data->rows;
+	snapshot->level = data->level;
+	memcpy(snapshot->goals, data->goals, sizeof(data->goals));
+	memcpy(snapshot->requirements, data->requirements, sizeof(data->requirements));
+	snapshot->moves = data->moves;
+	snapshot->moves_goal = data->moves_goal;
+	snapshot->score = data->score;
+	snapshot->infinite = data->infinite;
+	snapshot->hash = data->hash;
+	snapshot->counts = data->counts;
+}
+
+static void RestoreBoardSnapshot(struct Game* game, struct GamestateResources* data, struct BoardSnapshot* snapshot) {
+	memcpy(data->fields, snapshot->fields, sizeof(data->fields));
+	data->cols = snapshot->cols;
+	data->rows = snapshot->rows;
+	data->level = snapshot->level;
+	memcpy(data->goals, snapshot->goals, sizeof(data->goals));
+	memcpy(data->requirements, snapshot->requirements, sizeof(data->requirements));
+	data->moves = snapshot->moves;
+	data->moves_goal = snapshot->moves_goal;
+	data->score = snapshot->score;
+	data->infinite = snapshot->infinite;
+	data->hash = snapshot->hash;
+	data->counts = snapshot->counts;
+	data->moves_cache.valid = false;
+}
+
+static void PrepareBoard(struct Game* game, struct GamestateResources* data, int id, int cols, int rows) {
+	game->data->level = id;
+	LoadLevel(game, data, id);
+	if (cols && rows) {
+		// random fill of the given size
+		data->level.cols = cols;
+		data->level.rows = rows;
+		for (int i = 0; i < cols; i++) {
+			for (int j = 0; j < rows; j++) {
+				data->level.fields[i][j].field_type = FIELD_TYPE_ANIMAL;
+				data->level.fields[i][j].random_subtype = true;
+				data->level.fields[i][j].sleeping = false;
+				data->level.fields[i][j].super = false;
+			}
+		}
+	}
+	ApplyLevel(game, data);
+
+	// same as StartLevel, but without processing the board, which would queue up animations
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
+			if (data->level.fields[i][j].field_type == FIELD_TYPE_EMPTY) {
+				GenerateField(game, data, &data->fields[i][j], false);
+			}
+		}
+	}
+	do {
+		DoRemoval(game, data);
+		Gravity(game, data);
+	} while (MarkMatching(game, data));
+	StopAnimations(game, data);
+	TM_CleanQueue(data->timeline);
+}
+
+static struct Field* CenterField(struct Game* game, struct GamestateResources* data, int di, int dj) {
+	return &data->fields[data->cols / 2 + di][data->rows / 2 + dj];
+}
+
+static long BenchIsMatching(struct Game* game, struct GamestateResources* data) {
+	long ops = 0;
+	for (int r = 0; r < BENCHMARK_ROUNDS; r++) {
+		for (int i = 0; i < data->cols; i++) {
+			for (int j = 0; j < data->rows; j++) {
+				IsMatching(game, data, (struct FieldID){i, j});
+				ops++;
+			}
+		}
+	}
+	return ops;
+}
+
+static long BenchWillMatch(struct Game* game, struct GamestateResources* data) {
+	long ops = 0;
+	for (int r = 0; r < BENCHMARK_ROUNDS; r++) {
+		for (int i = 0; i < data->cols; i++) {
+			for (int j = 0; j < data->rows; j++) {
+				if (i + 1 < data->cols) {
+					WillMatch(game, data, (struct FieldID){i, j}, (struct FieldID){i + 1, j});
+					ops++;
+				}
+				if (j + 1 < data->rows) {
+					WillMatch(game, data, (struct FieldID){i, j}, (struct FieldID){i, j + 1});
+					ops++;
+				}
+			}
+		}
+	}
+	return ops;
+}
+
+static long BenchCountMoves(struct Game* game, struct GamestateResources* data) {
+	for (int r = 0; r < BENCHMARK_ROUNDS; r++) {
+		data->moves_cache.valid = false;
+		CountMoves(game, data);
+	}
+	return BENCHMARK_ROUNDS;
+}
+
+static long BenchMarkMatching(struct Game* game, struct GamestateResources* data) {
+	MarkMatching(game, data);
+	return 1;
+}
+
+static void SetupRemoval(struct Game* game, struct GamestateResources* data) {
+	// pretend that a 3x3 block in the middle got matched
+	for (int i = -1; i <= 1; i++) {
+		for (int j = -1; j <= 1; j++) {
+			struct Field* field = CenterField(game, data, i, j);
+			if (field->type != FIELD_TYPE_DISABLED) {
+				field->to_remove = true;
+			}
+		}
+	}
+}
+
+static long BenchCollect(struct Game* game, struct GamestateResources* data) {
+	Collect(game, data);
+	return 1;
+}
+
+static void SetupGravity(struct Game* game, struct GamestateResources* data) {
+	for (int i = -1; i <= 1; i++) {
+		for (int j = -1; j <= 1; j++) {
+			struct Field* field = CenterField(game, data, i, j);
+			if (field->type != FIELD_TYPE_DISABLED) {
+				field->type = FIELD_TYPE_EMPTY;
+				UpdateFieldHash(game, data, field);
+			}
+		}
+	}
+}
+
+static long BenchGravity(struct Game* game, struct GamestateResources* data) {
+	Gravity(game, data);
+	return 1;
+}
+
+static long BenchGenerateField(struct Game* game, struct GamestateResources* data) {
+	long ops = 0;
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
+			if (data->fields[i][j].type != FIELD_TYPE_DISABLED) {
+				GenerateField(game, data, &data->fields[i][j], false);
+				ops++;
+			}
+		}
+	}
+	return ops;
+}
+
+static void SetupSpecials(struct Game* game, struct GamestateResources* data) {
+	// a matched super animal next to the middle launches its special
+	for (int i = -1; i <= 1; i++) {
+		struct Field* field = CenterField(game, data, i, 0);
+		if (field->type == FIELD_TYPE_ANIMAL) {
+			field->data.animal.super = true;
+			field->to_remove = true;
+			UpdateFieldHash(game, data, field);
+			return;
+		}
+	}
+}
+
+static long BenchAnimateSpecials(struct Game* game, struct GamestateResources* data) {
+	AnimateSpecials(game, data);
+	return 1;
+}
+
+static long BenchLoadLevel(struct Game* game, struct GamestateResources* data) {
+	LoadLevel(game, data, data->level.id);
+	return 1;
+}
+
+static void SetupStoreLevel(struct Game* game, struct GamestateResources* data) {
+	data->level.id = BENCHMARK_LEVEL_ID;
+}
+
+static long BenchStoreLevel(struct Game* game, struct GamestateResources* data) {
+	StoreLevel(game, data);
+	return 1;
+}
+
+static struct {
+	char* name;
+	bool batched; // runs many cheap calls in a single measurement
+	void (*setup)(struct Game* game, struct GamestateResources* data);
+	long (*run)(struct Game* game, struct GamestateResources* data);
+} OPERATIONS[] = {
+	{"IsMatching", true, NULL, BenchIsMatching},
+	{"WillMatch", true, NULL, BenchWillMatch},
+	{"CountMoves", true, NULL, BenchCountMoves},
+	{"MarkMatching", false, NULL, BenchMarkMatching},
+	{"Collect", false, SetupRemoval, BenchCollect},
+	{"Gravity", false, SetupGravity, BenchGravity},
+	{"GenerateField", false, NULL, BenchGenerateField},
+	{"AnimateSpecials", false, SetupSpecials, BenchAnimateSpecials},
+	{"LoadLevel", false, NULL, BenchLoadLevel},
+	{"StoreLevel", false, SetupStoreLevel, BenchStoreLevel},
+};
+
+#define OPERATIONS_COUNT (int)(sizeof(OPERATIONS) / sizeof(OPERATIONS[0]))
+
+static bool ReferenceGenerateAnimal(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches) {
+	// GenerateAnimal as it used to be, minus the drawables and hashes
+	field->type = FIELD_TYPE_ANIMAL;
+	field->data.animal.sleeping = false;
+	field->data.animal.super = false;
+	int attempts = 0;
+	while (data->level.field_types[FIELD_TYPE_ANIMAL]) {
+		if (attempts++ == GENERATOR_ATTEMPTS) {
+			return false;
+		}
+		field->data.animal.type = RollRandom(data) % ANIMAL_TYPES;
+		if (!allow_matches && IsMatching(game, data, field->id)) {
+			continue;
+		}
+		if (data->level.animals[field->data.animal.type]) {
+			break;
+		}
+	}
+	if (RollRandom(data) / (float)RAND_MAX < 0.005) {
+		field->data.animal.sleeping = data->level.sleeping;
+	}
+	return true;
+}
+
+static bool ReferenceGenerateField(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches) {
+	// GenerateField as it used to be, minus the drawables and hashes; returns false where it would never finish
+	bool need_collectible = false, need_freefall = false, need_sleeping = false, need_animal = false, need_super = false,
+			 need_animal_type[ANIMAL_TYPES] = {}, need_collectible_type[COLLECTIBLE_TYPES] = {};
+	struct FieldCounts counts = CountFields(game, data);
+
+	for (int i = 0; i < 3; i++) {
+		if (data->goals[i].value <= 0) {
+			continue;
+		}
+		if (data->goals[i].type == GOAL_TYPE_FREEFALL) {
+			if (counts.freefalls == 0) {
+				need_freefall = true;
+			}
+		} else if (data->goals[i].type == GOAL_TYPE_COLLECTIBLE) {
+			if (counts.collectibles == 0) {
+				need_collectible = true;
+			}
+		}
+		for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
+			if ((data->goals[i].type - GOAL_TYPE_COLLECTIBLE - 1) == type) {
+				if (counts.collectible[type] == 0) {
+					need_collectible = true;
+					need_collectible_type[type] = true;
+				}
+			}
+		}
+	}
+
+	if (counts.freefalls < data->requirements[GOAL_TYPE_FREEFALL]) {
+		need_freefall = true;
+	}
+	if (counts.collectibles < data->requirements[GOAL_TYPE_COLLECTIBLE]) {
+		need_collectible = true;
+	}
+	if (counts.sleeping < data->requirements[GOAL_TYPE_SLEEPING]) {
+		need_sleeping = true;
+	}
+	if (counts.super < data->requirements[GOAL_TYPE_SUPER]) {
+		need_super = true;
+	}
+	for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
+		if (counts.collectible[type] < data->requirements[type + GOAL_TYPE_COLLECTIBLE + 1]) {
+			need_collectible = true;
+			need_collectible_type[type] = true;
+		}
+	}
+	for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
+		if (counts.animal[type] < data->requirements[type + GOAL_TYPE_ANIMAL + 1]) {
+			need_animal = true;
+			need_animal_type[type] = true;
+		}
+	}
+
+	for (int attempts = 0; attempts < GENERATOR_ATTEMPTS; attempts++) {
+		if (RollRandom(data) / (float)RAND_MAX < (need_freefall ? 0.5 : 0.001)) {
+			field->type = FIELD_TYPE_FREEFALL;
+			field->data.freefall.variant = RollRandom(data) % SPECIAL_ACTIONS[SPECIAL_TYPE_EGG].actions;
+			if (need_freefall || data->level.field_types[FIELD_TYPE_FREEFALL]) {
+				return true;
+			}
+		} else if (RollRandom(data) / (float)RAND_MAX < (need_collectible ? 0.5 : 0.01)) {
+			field->type = FIELD_TYPE_COLLECTIBLE;
+			field->data.collectible.variant = 0;
+			if (need_collectible) {
+				for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
+					if (need_collectible_type[type]) {
+						field->data.collectible.type = type;
+						return true;
+					}
+				}
+			}
+			int rolls = 0;
+			while (data->level.field_types[FIELD_TYPE_COLLECTIBLE]) {
+				if (rolls++ == GENERATOR_ATTEMPTS) {
+					return false;
+				}
+				field->data.collectible.type = RollRandom(data) % COLLECTIBLE_TYPES;
+				if (data->level.collectibles[field->data.collectible.type]) {
+					break;
+				}
+			}
+			if (need_collectible || data->level.field_types[FIELD_TYPE_COLLECTIBLE]) {
+				return true;
+			}
+		} else {
+			if (!ReferenceGenerateAnimal(game, data, field, allow_matches)) {
+				return false;
+			}
+			field->data.animal.super = need_super;
+			if (!field->data.animal.super) {
+				if (need_sleeping) {
+					field->data.animal.sleeping = true;
+				}
+			}
+			for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
+				if (need_animal_type[type]) {
+					field->data.animal.type = type;
+					break;
+				}
+			}
+			if (need_animal || data->level.field_types[FIELD_TYPE_ANIMAL]) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static int GeneratorBin(struct Field* field) {
+	switch (field->type) {
+		case FIELD_TYPE_FREEFALL:
+			return 0;
+		case FIELD_TYPE_COLLECTIBLE:
+			return 1 + field->data.collectible.type;
+		case FIELD_TYPE_ANIMAL:
+			return 1 + COLLECTIBLE_TYPES + field->data.animal.type * 3 + (field->data.animal.super ? 2 : (field->data.animal.sleeping ? 1 : 0));
+		default:
+			return -1;
+	}
+}
+
+static void CheckGenerator(struct Game* game, struct GamestateResources* data, struct GeneratorCheckResult* result) {
+	long reference[GENERATOR_BINS] = {0}, current[GENERATOR_BINS] = {0};
+	long samples = 0;
+	for (int s = 0; s < GENERATOR_SEEDS; s++) {
+		for (int i = 0; i < data->cols; i++) {
+			for (int j = 0; j < data->rows; j++) {
+				struct Field* field = &data->fields[i][j];
+				if (field->type == FIELD_TYPE_DISABLED) {
+					continue;
+				}
+				// GenerateField only changes the field itself, the counts and the hash
+				struct Field saved = *field;
+				struct FieldCounts counts = data->counts;
+				uint64_t hash = data->hash;
+
+				// independent seeds for both, as their outcomes get compared as independent samples
+				data->random = ((uint64_t)s << 32 | (uint64_t)(i * MAX_ROWS + j)) * 2;
+				bool finished = ReferenceGenerateField(game, data, field, false);
+				int bin = GeneratorBin(field);
+				*field = saved;
+				if (!finished || bin < 0) {
+					// the old loops would hang here, while the new code has a defined outcome
+					result->skipped++;
+					continue;
+				}
+				reference[bin]++;
+
+				data->random = ((uint64_t)s << 32 | (uint64_t)(i * MAX_ROWS + j)) * 2 + 1;
+				GenerateField(game, data, field, false);
+				bin = GeneratorBin(field);
+				if (bin >= 0) {
+					current[bin]++;
+				}
+				*field = saved;
+				data->counts = counts;
+				data->hash = hash;
+				UpdateDrawable(game, data, field->id);
+				samples++;
+			}
+		}
+	}
+	result->samples += samples;
+
+	// two-proportion z-test for every outcome
+	for (int b = 0; b < GENERATOR_BINS && samples; b++) {
+		double p = (reference[b] + current[b]) / (2.0 * samples);
+		if (p <= 0.0 || p >= 1.0) {
+			continue;
+		}
+		double z = fabs(reference[b] - current[b]) / samples / sqrt(p * (1.0 - p) * 2.0 / samples);
+		if (z > result->max_z) {
+			result->max_z = z;
+		}
+	}
+}
+
+static char* ScratchLevelPath(struct Game* game) {
+	char name[255];
+	snprintf(name, 255, "%d.lvl", BENCHMARK_LEVEL_ID);
+	ALLEGRO_PATH* path = al_get_standard_path(ALLEGRO_USER_DATA_PATH);
+	al_set_path_filename(path, name);
+	char* filename = strdup(al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP));
+	al_destroy_path(path);
+	return filename;
+}
+
+static void Measure(struct Game* game, struct GamestateResources* data, struct BoardSnapshot* snapshot, int op, struct BoardBenchmarkResult* result) {
+	for (int r = 0; r < (OPERATIONS[op].batched ? 1 : BENCHMARK_REPEATS); r++) {
+		RestoreBoardSnapshot(game, data, snapshot);
+		if (OPERATIONS[op].setup) {
+			OPERATIONS[op].setup(game, data);
+		}
+		long allocs = BenchmarkAllocations();
+		double start = al_get_time();
+		result->ops += OPERATIONS[op].run(game, data);
+		result->time += al_get_time() - start;
+		result->allocs += BenchmarkAllocations() - allocs;
+		// drop the animations queued up by the operation
+		TM_CleanQueue(data->timeline);
+	}
+}
+
+static void ReadBaseline(struct Game* game, const char* filename, struct BoardBenchmarkResult* results) {
+	FILE* file = fopen(filename, "r");
+	if (!file) {
+		PrintConsole(game, "Could not open benchmark baseline file: %s", filename);
+		return;
+	}
+	char line[255];
+	while (fgets(line, sizeof(line), file)) {
+		char name[64];
+		char* pos = strstr(line, "\"name\": \"");
+		if (!pos || sscanf(pos, "\"name\": \"%63[^\"]\"", name) != 1) {
+			continue;
+		}
+		for (int op = 0; op < OPERATIONS_COUNT; op++) {
+			if (strcmp(name, OPERATIONS[op].name) != 0) {
+				continue;
+			}
+			pos = strstr(line, "\"ns\": ");
+			if (pos) {
+				sscanf(pos, "\"ns\": %lf", &results[op].baseline_ns);
+			}
+			pos = strstr(line, "\"allocs\": ");
+			if (pos) {
+				sscanf(pos, "\"allocs\": %lf", &results[op].baseline_allocs);
+			}
+		}
+	}
+	fclose(file);
+}
+
+static void WriteResults(struct Game* game, struct BoardBenchmarkResult* results, struct GeneratorCheckResult* generator, int boards) {
+	struct Benchmark* benchmark = &game->data->benchmark;
+	FILE* file = stdout;
+	if (benchmark->board_output) {
+		file = fopen(benchmark->board_output, "w");
+		if (!file) {
+			PrintConsole(game, "Could not open benchmark output file: %s", benchmark->board_output);
+			file = stdout;
+		}
+	}
+
+	int regressions = 0;
+	fprintf(file, "{\n\t\"game\": \"%s\",\n\t\"version\": \"%s-%s\",\n\t\"boards\": %d,\n\t\"operations\": [\n", LIBSUPERDERPY_GAMENAME, LIBSUPERDERPY_GAME_VERSION, LIBSUPERDERPY_GAME_GIT_REV, boards);
+	for (int op = 0; op < OPERATIONS_COUNT; op++) {
+		struct BoardBenchmarkResult* result = &results[op];
+		double ns = result->ops ? result->time * 1e9 / result->ops : 0.0;
+		char allocs[32] = "null";
+		if (BenchmarkAllocations() >= 0 && result->ops) {
+			snprintf(allocs, sizeof(allocs), "%.3f", result->allocs / (double)result->ops);
+		}
+		fprintf(file, "\t\t{\"name\": \"%s\", \"ops\": %ld, \"ns\": %.3f, \"allocs\": %s", OPERATIONS[op].name, result->ops, ns, allocs);
+		if (result->baseline_ns > 0.0) {
+			bool regression = ns > result->baseline_ns * (1.0 + BENCHMARK_TOLERANCE);
+			if (BenchmarkAllocations() >= 0 && result->ops && result->baseline_allocs >= 0.0) {
+				regression |= result->allocs / (double)result->ops > result->baseline_allocs + 0.001;
+			}
+			fprintf(file, ", \"baseline_ns\": %.3f, \"regression\": %s", result->baseline_ns, regression ? "true" : "false");
+			if (regression) {
+				PrintConsole(game, "Benchmark regression: %s takes %.3f ns (baseline %.3f ns)", OPERATIONS[op].name, ns, result->baseline_ns);
+				regressions++;
+			}
+		}
+		fprintf(file, "}%s\n", (op < OPERATIONS_COUNT - 1) ? "," : "");
+	}
+	bool mismatch = generator->max_z > GENERATOR_TOLERANCE;
+	if (mismatch) {
+		PrintConsole(game, "Benchmark regression: GenerateField differs from the reference generator (z = %.2f)", generator->max_z);
+		regressions++;
+	}
+	fprintf(file, "\t],\n\t\"generator\": {\"samples\": %ld, \"skipped\": %ld, \"max_z\": %.3f, \"mismatch\": %s},\n", generator->samples, generator->skipped, generator->max_z, mismatch ? "true" : "false");
+	fprintf(file, "\t\"regressions\": %d\n}\n", regressions);
+
+	if (file != stdout) {
+		fclose(file);
+	} else {
+		fflush(file);
+	}
+}
+
+void RunBoardBenchmark(struct Game* game, struct GamestateResources* data) {
+	struct BoardBenchmarkResult results[OPERATIONS_COUNT] = {};
+	struct GeneratorCheckResult generator = {0};
+	for (int op = 0; op < OPERATIONS_COUNT; op++) {
+		results[op].baseline_ns = -1.0;
+		results[op].baseline_allocs = -1.0;
+	}
+	if (game->data->benchmark.baseline) {
+		ReadBaseline(game, game->data->benchmark.baseline, results);
+	}
+
+	char* scratch = ScratchLevelPath(game);
+	bool store = !al_filename_exists(scratch);
+	if (!store) {
+		PrintConsole(game, "Not benchmarking StoreLevel, %s already exists!", scratch);
+	}
+
+	struct BoardSnapshot* snapshot = calloc(1, sizeof(struct BoardSnapshot));
+	double start = al_get_time();
+
+	int levels = 0;
+	while (LevelExists(game, levels + 1)) {
+		levels++;
+	}
+
+	// the level corpus, followed by random fills of the default and the biggest size
+	for (int b = 0; b < levels + 2; b++) {
+		if (b < levels) {
+			PrepareBoard(game, data, b + 1, 0, 0);
+		} else if (b == levels) {
+			PrepareBoard(game, data, 0, DEFAULT_COLS, DEFAULT_ROWS);
+		} else {
+			PrepareBoard(game, data, 0, MAX_COLS, MAX_ROWS);
+		}
+		TakeBoardSnapshot(game, data, snapshot);
+		for (int op = 0; op < OPERATIONS_COUNT; op++) {
+			if (OPERATIONS[op].run == BenchStoreLevel && !store) {
+				continue;
+			}
+			Measure(game, data, snapshot, op, &results[op]);
+		}
+		RestoreBoardSnapshot(game, data, snapshot);
+		CheckGenerator(game, data, &generator);
+		RestoreBoardSnapshot(game, data, snapshot);
+	}
+
+	if (store) {
+		al_remove_filename(scratch);
+	}
+	free(scratch);
+	free(snapshot);
+
+	PrintConsole(game, "Board benchmark finished in %.3f s (%d boards).", al_get_time() - start, levels + 2);
+	WriteResults(game, results, &generator, levels + 2);
+
+	QuitGame(game, false);
+}
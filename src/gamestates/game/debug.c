@@ -19,6 +19,7 @@
  */
 
 #include "game.h"
+#include <inttypes.h>
 
 static void UpdateField(struct Game* game, struct GamestateResources* data, struct Field* field) {
 	if (field->type == FIELD_TYPE_FREEFALL) {
@@ -32,6 +33,23 @@ static void UpdateField(struct Game* game, struct GamestateResources* data, stru
 		field->data.collectible.variant = 0;
 	}
 	UpdateDrawable(game, data, field->id);
+	UpdateFieldHash(game, data, field);
+}
+
+static void ResizeBoard(struct Game* game, struct GamestateResources* data, int cols, int rows) {
+	// newly uncovered fields are left empty, so they can be regenerated
+	for (int i = 0; i < MAX_COLS; i++) {
+		for (int j = 0; j < MAX_ROWS; j++) {
+			bool inside = i < cols && j < rows, was_inside = i < data->cols && j < data->rows;
+			if (inside != was_inside) {
+				data->fields[i][j].type = inside ? FIELD_TYPE_EMPTY : FIELD_TYPE_DISABLED;
+				UpdateFieldHash(game, data, &data->fields[i][j]);
+			}
+		}
+	}
+	data->cols = cols;
+	data->rows = rows;
+	UpdateLayout(game, data);
 }
 
 void HandleDebugEvent(struct Game* game, struct GamestateResources* data, ALLEGRO_EVENT* ev) {
@@ -52,6 +70,10 @@ void HandleDebugEvent(struct Game* game, struct GamestateResources* data, ALLEGR
 			AutoMove(game, data);
 			return;
 		}
+		if (ev->keyboard.keycode == ALLEGRO_KEY_K) {
+			SkipTurn(game, data);
+			return;
+		}
 
 		if (ev->keyboard.keycode == ALLEGRO_KEY_Z) {
 			FinishLevel(game, data);
@@ -151,6 +173,19 @@ void DrawDebugInterface(struct Game* game, struct GamestateResources* data) {
 			igTextColored(data->locked ? gray : white, "Enabled: %d", !data->locked);
 			igText("Particles: %d", data->particles->active);
 			igText("Possible moves: %d", CountMoves(game, data));
+			igTextColored(data->turn.running ? white : gray, "Turn: %s", data->turn.finishes ? "finishes the level" : "goes on");
+			uint64_t hash = HashBoard(game, data);
+			if (hash == data->hash) {
+				igText("Board hash: %016" PRIx64, data->hash);
+			} else {
+				igTextColored(red, "Board hash: %016" PRIx64 " DESYNC (%016" PRIx64 ")", data->hash, hash);
+			}
+			struct FieldCounts counts = CountFields(game, data);
+			if (!memcmp(&counts, &data->counts, sizeof(struct FieldCounts))) {
+				igText("Freefalls: %d, collectibles: %d, sleeping: %d, super: %d", data->counts.freefalls, data->counts.collectibles, data->counts.sleeping, data->counts.super);
+			} else {
+				igTextColored(red, "Field counts DESYNC");
+			}
 			igSeparator();
 
 			igInputInt("Moves taken", &data->moves, 1, 10, 0);
@@ -166,6 +201,11 @@ void DrawDebugInterface(struct Game* game, struct GamestateResources* data) {
 				ShowHint(game, data);
 			}
 
+			igSameLine(0, 10);
+			if (igButton("Skip", (ImVec2){0, 0})) {
+				SkipTurn(game, data);
+			}
+
 			igSameLine(0, 10);
 			if (igButton("Process", (ImVec2){0, 0})) {
 				Gravity(game, data);
@@ -182,9 +222,9 @@ void DrawDebugInterface(struct Game* game, struct GamestateResources* data) {
 			}
 		}
 		if (igCollapsingHeader("Board", 0)) {
-			for (int j = 0; j < ROWS; j++) {
-				igColumns(COLS, "fields", true);
-				for (int i = 0; i < COLS; i++) {
+			for (int j = 0; j < data->rows; j++) {
+				igColumns(data->cols, "fields", true);
+				for (int i = 0; i < data->cols; i++) {
 					struct FieldID id = {.i = i, .j = j};
 					struct Field* field = GetField(game, data, id);
 
@@ -240,7 +280,7 @@ void DrawDebugInterface(struct Game* game, struct GamestateResources* data) {
 					}
 
 					char buf[12];
-					snprintf(buf, 12, "transmute%d", j * COLS + i);
+					snprintf(buf, 12, "transmute%d", j * MAX_COLS + i);
 
 					if (igIsItemClicked(0)) {
 						data->current = (struct FieldID){i, j};
@@ -302,10 +342,11 @@ void DrawDebugInterface(struct Game* game, struct GamestateResources* data) {
 
 		if (igCollapsingHeader("Configuration", 0)) {
 			if (igButton("Clear fields", (ImVec2){0, 0})) {
-				for (int i = 0; i < COLS; i++) {
-					for (int j = 0; j < ROWS; j++) {
+				for (int i = 0; i < data->cols; i++) {
+					for (int j = 0; j < data->rows; j++) {
 						if (data->fields[i][j].type != FIELD_TYPE_DISABLED) {
 							data->fields[i][j].type = FIELD_TYPE_EMPTY;
+							UpdateFieldHash(game, data, &data->fields[i][j]);
 						}
 					}
 				}
@@ -313,19 +354,21 @@ void DrawDebugInterface(struct Game* game, struct GamestateResources* data) {
 
 			igSameLine(0, 10);
 			if (igButton("Reset board", (ImVec2){0, 0})) {
-				for (int i = 0; i < COLS; i++) {
-					for (int j = 0; j < ROWS; j++) {
+				for (int i = 0; i < data->cols; i++) {
+					for (int j = 0; j < data->rows; j++) {
 						data->fields[i][j].type = FIELD_TYPE_EMPTY;
+						UpdateFieldHash(game, data, &data->fields[i][j]);
 					}
 				}
 			}
 
 			igSameLine(0, 10);
 			if (igButton("Regenerate", (ImVec2){0, 0})) {
-				for (int i = 0; i < COLS; i++) {
-					for (int j = 0; j < ROWS; j++) {
+				for (int i = 0; i < data->cols; i++) {
+					for (int j = 0; j < data->rows; j++) {
 						if (data->fields[i][j].type != FIELD_TYPE_DISABLED) {
 							data->fields[i][j].type = FIELD_TYPE_EMPTY;
+							UpdateFieldHash(game, data, &data->fields[i][j]);
 						}
 					}
 				}
@@ -337,6 +380,15 @@ void DrawDebugInterface(struct Game* game, struct GamestateResources* data) {
 				StopAnimations(game, data);
 			}
 
+			int cols = data->cols, rows = data->rows;
+			igInputInt("Columns", &cols, 1, 1, 0);
+			igInputInt("Rows", &rows, 1, 1, 0);
+			cols = fmax(MIN_COLS, fmin(cols, MAX_COLS));
+			rows = fmax(MIN_ROWS, fmin(rows, MAX_ROWS));
+			if (cols != data->cols || rows != data->rows) {
+				ResizeBoard(game, data, cols, rows);
+			}
+
 #define AddFieldConfigItem(t)                                                       \
 	if (FIELD_TYPE_##t <= FIELD_TYPE_COLLECTIBLE) {                                   \
 		igCheckbox(#t "##field_type_config", &data->level.field_types[FIELD_TYPE_##t]); \
@@ -442,6 +494,28 @@ void DrawDebugInterface(struct Game* game, struct GamestateResources* data) {
 					StartLevel(game, data);
 				}
 			}
+
+			igSeparator();
+			if (data->verifier) {
+				igText("Verifying...");
+			} else if (igButton("Verify solvability", (ImVec2){0, 0})) {
+				VerifyLevel(game, data);
+			}
+			if (data->solver.time && !data->verifier) {
+				if (data->solver.solved) {
+					igTextColored(green, "Winnable in %d moves", data->solver.depth);
+					for (int i = 0; i < data->solver.depth; i++) {
+						igText("%d: %dx%d with %dx%d", i + 1, data->solver.line[i].one.i, data->solver.line[i].one.j, data->solver.line[i].two.i, data->solver.line[i].two.j);
+					}
+				} else if (data->solver.finished) {
+					igTextColored(red, "Not winnable without lucky refills");
+				} else if (data->solver.truncated) {
+					igTextColored(yellow, "Inconclusive, only %d moves were searched", SOLVER_MAX_DEPTH);
+				} else {
+					igTextColored(yellow, "Search gave up");
+				}
+				igText("%ld positions in %.2fs", data->solver.nodes, data->solver.time);
+			}
 		}
 
 		igEnd();
@@ -42,7 +42,7 @@ struct FieldID ToLeft(struct FieldID id) {
 
 struct FieldID ToRight(struct FieldID id) {
 	id.i++;
-	if (id.i >= COLS) {
+	if (id.i >= MAX_COLS) {
 		return (struct FieldID){-1, -1};
 	}
 	return id;
@@ -58,7 +58,7 @@ struct FieldID ToTop(struct FieldID id) {
 
 struct FieldID ToBottom(struct FieldID id) {
 	id.j++;
-	if (id.j >= ROWS) {
+	if (id.j >= MAX_ROWS) {
 		return (struct FieldID){-1, -1};
 	}
 	return id;
@@ -92,7 +92,7 @@ int IsMatching(struct Game* game, struct GamestateResources* data, struct FieldI
 		return 0;
 	}
 
-	struct Field *lfields[COLS] = {}, *tfields[ROWS] = {};
+	struct Field *lfields[MAX_COLS] = {}, *tfields[MAX_ROWS] = {};
 	struct FieldID (*callbacks[])(struct FieldID) = {ToLeft, ToRight, ToTop, ToBottom};
 	int* accumulators[] = {&lchain, &lchain, &tchain, &tchain};
 	struct Field** lists[] = {lfields, lfields, tfields, tfields};
@@ -126,7 +126,7 @@ int IsMatching(struct Game* game, struct GamestateResources* data, struct FieldI
 	if (chain) {
 		chain++;
 		if (!orig->match_mark) {
-			orig->match_mark = id.j * COLS + id.i;
+			orig->match_mark = id.j * MAX_COLS + id.i;
 		}
 		if (lchain >= 2) {
 			for (int i = 0; i < lchain; i++) {
@@ -12,11 +12,28 @@
 #define HINT_TIME 1.0
 #define LAUNCHING_TIME 1.5
 #define COLLECTING_TIME 0.6
+#define FAST_CASCADES_SPEED 2.0 // how much faster the board animates with fast cascades enabled
 
 #define BLUR_DIVIDER 8
-
-#define COLS 8
-#define ROWS 8
+#define MAX_PARTICLES 4096
+#define ASSET_BITMAPS 11 // streamed in the background, see StartLoadingAssets
+#define LOGIC_STEP (1.0 / 120.0) // fine enough for turns to start on the frame they were input on at 120 Hz
+#define LOGIC_MAX_STEPS 30 // after a longer stall, the rest of it is skipped
+
+#define SEARCH_DEPTH 2
+#define SEARCH_NODES 4096 // simulated moves per search, so hints don't depend on the machine's speed
+#define SEARCH_BUDGET 0.05 // seconds, only a safety cap for very slow machines
+#define SOLVER_MAX_DEPTH 64
+
+// board dimensions are set by the level, fields beyond them are disabled
+#define MIN_COLS 6
+#define MIN_ROWS 6
+#define MAX_COLS 12
+#define MAX_ROWS 16
+#define DEFAULT_COLS 8
+#define DEFAULT_ROWS 8
+
+#define FIELD_SIZE 90 // on a default sized board, sprites are scaled relative to it
 
 #define FOREACH_ANIMAL(ANIMAL) \
 	ANIMAL(BEE)                  \
@@ -144,6 +161,15 @@ static struct {
 
 SUPPRESS_END
 
+// spritesheets of an animal archetype; the first MAX_ACTIONS are its ANIMAL_ACTIONS
+enum ANIMAL_SPRITESHEET {
+	ANIMAL_SPRITESHEET_STAND = MAX_ACTIONS,
+	ANIMAL_SPRITESHEET_BLINK,
+	ANIMAL_SPRITESHEET_SUPER, // from the super archetype
+	//
+	ANIMAL_SPRITESHEETS
+};
+
 struct FieldID {
 	int i;
 	int j;
@@ -176,17 +202,30 @@ struct Field {
 	struct Character *drawable, *overlay;
 	bool overlay_visible;
 
+	uint64_t hash; // Zobrist key this field currently contributes to the board hash
+	struct {
+		bool valid;
+		enum FIELD_TYPE type;
+		int subtype;
+		bool sleeping, super;
+	} counted; // state this field is currently accounted as in the board counts
+
 	float highlight;
 
 	struct {
 		struct Tween hiding, falling, swapping, shaking, hinting, launching, collecting;
 		struct FieldID swapee, super;
 		int fall_levels, level_no;
-		int time_to_action, action_time;
-		int time_to_blink, blink_time;
+		int64_t action_at, blink_at, busy_until; // on the idle clock, see idle.c
+		bool busy;
 	} animation;
 };
 
+struct FieldCounts {
+	int freefalls, collectibles, sleeping, super;
+	int collectible[COLLECTIBLE_TYPES], animal[ANIMAL_TYPES];
+};
+
 struct Goal {
 	enum GOAL_TYPE type;
 	int value;
@@ -205,7 +244,8 @@ struct Level {
 		bool random_subtype;
 		bool sleeping;
 		bool super;
-	} fields[COLS][ROWS];
+	} fields[MAX_COLS][MAX_ROWS];
+	int cols, rows;
 	bool supers, sleeping;
 
 	struct Goal goals[3];
@@ -215,6 +255,72 @@ struct Level {
 	int id;
 };
 
+// a stripped down copy of the board, used to evaluate moves without touching the real one
+struct SimField {
+	enum FIELD_TYPE type;
+	int subtype, variant;
+	bool sleeping, super, unknown;
+	int matched, match_mark;
+	bool to_remove, handled;
+};
+
+struct SimBoard {
+	struct SimField fields[MAX_COLS][MAX_ROWS];
+	int cols, rows;
+	struct Goal goals[3];
+	int score;
+	bool supers; // copied from the level, so simulating without sampling never reads the gamestate
+	uint64_t random; // state of the generator used for sampled refills
+};
+
+struct Move {
+	struct FieldID one, two;
+	double value;
+};
+
+#define MAX_MOVES (MAX_COLS * MAX_ROWS * 2)
+
+struct SolverResult {
+	bool finished, solved;
+	bool truncated; // the level allows more than SOLVER_MAX_DEPTH moves, so not finding a line is inconclusive
+	int depth;
+	long nodes;
+	double time;
+	struct Move line[SOLVER_MAX_DEPTH];
+};
+
+struct StressSample {
+	double time, turns_per_second, worst_frame;
+	int particles, queue;
+	long rss;
+};
+
+struct StressTest {
+	double start, last_frame, last_sample;
+	long turns, start_rss;
+	struct StressSample peak, sample; // high-water marks of the whole run and the current sample
+	long sample_turns;
+	struct StressSample* samples;
+	int count, size;
+	bool finished;
+};
+
+enum HIT_TARGET {
+	HIT_TARGET_RESTART,
+	HIT_TARGET_BEETLE,
+	HIT_TARGET_ACORN_TOP,
+	HIT_TARGET_ACORN_BOTTOM,
+	HIT_TARGET_HINT,
+	HIT_TARGET_HOME,
+	HIT_TARGETS
+};
+
+struct Turn {
+	bool running; // from the swap until the board settles
+	bool finishes; // the goals get reached no matter what gets spawned
+	struct SimBoard after; // predicted outcome, with refills left unknown
+};
+
 struct GamestateResources {
 	// This struct is for every resource allocated and used by your gamestate.
 	// It gets created on load and then gets passed around to all other function calls.
@@ -228,8 +334,47 @@ struct GamestateResources {
 
 	struct Character* animal_archetypes[sizeof(ANIMALS) / sizeof(ANIMALS[0])];
 	struct Character* special_archetypes[sizeof(SPECIALS) / sizeof(SPECIALS[0])];
+
+	// spritesheets of the archetypes, looked up once after loading, see ResolveSpritesheets
+	struct Spritesheet* animal_spritesheets[ANIMAL_TYPES][ANIMAL_SPRITESHEETS];
+	struct Spritesheet* special_spritesheets[SPECIAL_TYPES][MAX_ACTIONS]; // in the order of SPECIAL_ACTIONS
+
 	struct FieldID current, hovered, swap1, swap2;
-	struct Field fields[COLS][ROWS];
+	struct {
+		struct FieldID one, two;
+		bool valid;
+	} queued; // swap made while the previous turn was still being shown, see QueueTurn
+	struct Field fields[MAX_COLS][MAX_ROWS];
+	int cols, rows;
+
+	struct {
+		struct FieldID ids[MAX_COLS * MAX_ROWS];
+		int count;
+		bool listed[MAX_COLS][MAX_ROWS];
+	} animating; // fields with running tweens, see StartFieldTween
+
+	struct {
+		double remainder; // time not simulated yet, less than LOGIC_STEP
+	} logic;
+
+	struct {
+		double time;
+		int64_t clock;
+		struct FieldID heap[MAX_COLS * MAX_ROWS];
+		int index[MAX_COLS][MAX_ROWS];
+		int count;
+	} idle; // idle animation timers, see idle.c
+
+	struct {
+		int x, y;
+		float size;
+	} cell; // position of the board and size of a single field on screen, see UpdateLayout
+
+	struct {
+		uint8_t* cells; // masks of HIT_TARGETs that may be found in each cell
+		int cols, rows;
+		bool valid;
+	} hit; // see hittest.c
 
 	struct Timeline* timeline;
 
@@ -237,6 +382,20 @@ struct GamestateResources {
 
 	ALLEGRO_SHADER *combine_shader, *desaturate_shader;
 
+	struct {
+		ALLEGRO_THREAD* thread;
+		int bitmap_flags;
+		const ALLEGRO_FILE_INTERFACE* file_interface; // the main thread's, so the worker opens files the same way
+		bool cache_enabled;
+		struct {
+			const char* name;
+			char* path;
+			ALLEGRO_BITMAP** bitmap;
+		} bitmaps[ASSET_BITMAPS];
+		int count;
+		double start, end; // when the decoding was going on, for the startup benchmark
+	} assets; // see StartLoadingAssets
+
 	bool locked, clicked;
 
 	struct ParticleBucket* particles;
@@ -246,7 +405,7 @@ struct GamestateResources {
 	struct {
 		struct Character* character;
 		struct Tween tween;
-	} acorn_top, acorn_bottom, nests[COLS];
+	} acorn_top, acorn_bottom, nests[MAX_COLS];
 
 	float snail_blink;
 
@@ -259,6 +418,20 @@ struct GamestateResources {
 	struct Tween goal_tween[3];
 
 	struct Level level;
+	struct SolverResult solver;
+	struct Solver* verifier; // running VerifyLevel, see PollLevelVerification
+
+	uint64_t hash; // kept up to date with every change of the board, see zobrist.c
+	struct {
+		uint64_t hash;
+		int moves;
+		bool valid;
+	} moves_cache;
+	struct FieldCounts counts; // updated along with the hash, see generator.c
+	uint64_t random; // state of the random generator used by the rules, see RollRandom
+	struct Turn turn; // see turn.c
+
+	struct StressTest stress; // see stress.c
 
 	bool debug, paused, menu, done, failed, restart_hover, infinite, goal_lock;
 	float counter, counter_speed, counter_strength;
@@ -268,6 +441,8 @@ struct GamestateResources {
 void Turn(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two);
 bool ShowHint(struct Game* game, struct GamestateResources* data);
 bool AutoMove(struct Game* game, struct GamestateResources* data);
+void QueueTurn(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two);
+void RunQueuedTurn(struct Game* game, struct GamestateResources* data);
 
 // fields
 bool IsSameID(struct FieldID one, struct FieldID two);
@@ -285,6 +460,23 @@ int IsMatchExtension(struct Game* game, struct GamestateResources* data, struct
 int ShouldBeCollected(struct Game* game, struct GamestateResources* data, struct FieldID id);
 bool WillMatch(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two);
 
+// generator
+void GenerateAnimal(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches);
+void GenerateField(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches);
+void UpdateFieldCounts(struct Game* game, struct GamestateResources* data, struct Field* field);
+struct FieldCounts CountFields(struct Game* game, struct GamestateResources* data);
+
+// hittest
+bool IsOnHitTarget(struct Game* game, struct GamestateResources* data, enum HIT_TARGET target, float x, float y);
+struct FieldID GetFieldAt(struct Game* game, struct GamestateResources* data, float x, float y);
+struct FieldID GetSwipeTarget(struct Game* game, struct GamestateResources* data, struct FieldID from, float x, float y);
+void DestroyHitGrid(struct Game* game, struct GamestateResources* data);
+
+// idle
+void ResetIdleAnimations(struct Game* game, struct GamestateResources* data);
+void UpdateIdleAnimations(struct Game* game, struct GamestateResources* data, double delta);
+void SwapIdleAnimations(struct GamestateResources* data, struct FieldID one, struct FieldID two);
+
 // levels
 void LoadLevel(struct Game* game, struct GamestateResources* data, int id);
 void StartLevel(struct Game* game, struct GamestateResources* data);
@@ -300,20 +492,36 @@ void CopyLevel(struct Game* game, struct GamestateResources* data);
 void UpdateGoal(struct Game* game, struct GamestateResources* data, enum GOAL_TYPE type, int val);
 void AddScore(struct Game* game, struct GamestateResources* data, int val);
 int MarkMatching(struct Game* game, struct GamestateResources* data);
-void GenerateAnimal(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches);
-void GenerateField(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches);
+int Collect(struct Game* game, struct GamestateResources* data);
 void Gravity(struct Game* game, struct GamestateResources* data);
 void ProcessFields(struct Game* game, struct GamestateResources* data);
+bool CheckGoals(struct Game* game, struct GamestateResources* data);
 bool CanBeMatched(struct Game* game, struct GamestateResources* data, struct FieldID id);
 int CountMoves(struct Game* game, struct GamestateResources* data);
 void DoRemoval(struct Game* game, struct GamestateResources* data);
 void StopAnimations(struct Game* game, struct GamestateResources* data);
+struct Tween* StartFieldTween(struct Game* game, struct GamestateResources* data, struct Field* field, struct Tween* tween, double start, double stop, enum TWEEN_STYLE style, double duration);
+void UpdateFieldAnimations(struct Game* game, struct GamestateResources* data, double delta);
 void Swap(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two);
 void StartSwapping(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two);
 void StartBadSwapping(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two);
 void SpawnParticles(struct Game* game, struct GamestateResources* data, struct FieldID id, int num);
 TM_ACTION(DispatchAnimations);
 
+// shuffle
+bool ShuffleAnimals(struct Game* game, struct GamestateResources* data);
+
+// stress
+void StartStressTest(struct Game* game, struct GamestateResources* data);
+void UpdateStressTest(struct Game* game, struct GamestateResources* data);
+void DestroyStressTest(struct Game* game, struct GamestateResources* data);
+
+// turn
+int RollRandom(struct GamestateResources* data);
+int RollRandomState(uint64_t* state);
+void PredictTurn(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two, bool bad);
+bool SkipTurn(struct Game* game, struct GamestateResources* data);
+
 // specials
 bool AnimateSpecials(struct Game* game, struct GamestateResources* data);
 void TurnMatchToSuper(struct Game* game, struct GamestateResources* data, int matched, int mark);
@@ -326,14 +534,41 @@ bool DandelionParticle(struct Game* game, struct ParticleState* particle, double
 bool IsValidMove(struct FieldID one, struct FieldID two);
 bool IsSwappable(struct Game* game, struct GamestateResources* data, struct FieldID id);
 bool AreSwappable(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two);
+void ResolveSpritesheets(struct Game* game, struct GamestateResources* data);
+bool IsStanding(struct Game* game, struct GamestateResources* data, struct Field* field);
+void SelectAnimalSpritesheet(struct Game* game, struct GamestateResources* data, struct Field* field, enum ANIMAL_SPRITESHEET spritesheet);
+void SelectRandomAnimalAction(struct Game* game, struct GamestateResources* data, struct Field* field);
 void UpdateDrawable(struct Game* game, struct GamestateResources* data, struct FieldID id);
 void DrawField(struct Game* game, struct GamestateResources* data, struct FieldID id);
 void DrawOverlay(struct Game* game, struct GamestateResources* data, struct FieldID id);
+void UpdateLayout(struct Game* game, struct GamestateResources* data);
+
+// simulation
+void TakeSnapshot(struct Game* game, struct GamestateResources* data, struct SimBoard* board);
+void TakeLevelSnapshot(struct Game* game, struct GamestateResources* data, struct SimBoard* board);
+bool AreSimGoalsReached(struct SimBoard* board);
+int ListSimMoves(struct SimBoard* board, struct Move* moves);
+void SimulateMove(struct GamestateResources* data, struct SimBoard* board, struct FieldID one, struct FieldID two, bool sample);
+bool FindBestMove(struct Game* game, struct GamestateResources* data, int depth, int nodes, double budget, struct Move* move);
+
+// solver
+void VerifyLevel(struct Game* game, struct GamestateResources* data);
+void PollLevelVerification(struct Game* game, struct GamestateResources* data);
+void StopLevelVerification(struct Game* game, struct GamestateResources* data);
+
+// zobrist
+uint64_t ZobristKey(int i, int j, enum FIELD_TYPE type, int subtype, int variant, bool sleeping, bool super);
+uint64_t HashSimBoard(struct SimBoard* board);
+uint64_t HashBoard(struct Game* game, struct GamestateResources* data);
+void UpdateFieldHash(struct Game* game, struct GamestateResources* data, struct Field* field);
 
 // scene
 void DrawScene(struct Game* game, struct GamestateResources* data);
 void UpdateBlur(struct Game* game, struct GamestateResources* data);
 
+// benchmarks
+void RunBoardBenchmark(struct Game* game, struct GamestateResources* data);
+
 // debug
 void HandleDebugEvent(struct Game* game, struct GamestateResources* data, ALLEGRO_EVENT* ev);
 void DrawDebugInterface(struct Game* game, struct GamestateResources* data);
@@ -0,0 +1,291 @@
+/*! \file generator.c
+ *  \brief Generating new fields during refills and level setup.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * The generator used to retry random picks until one of them was allowed,
+ * rescanning the whole board for every generated field. Now the number of
+ * fields of each kind is kept up to date by UpdateFieldCounts (called by
+ * UpdateFieldHash on every change of the board) and the outcomes are drawn
+ * directly from the set of allowed ones, with the same probabilities the
+ * retrying loops used to end up with.
+ */
+
+static void CountField(struct FieldCounts* counts, enum FIELD_TYPE type, int subtype, bool sleeping, bool super, int delta) {
+	switch (type) {
+		case FIELD_TYPE_FREEFALL:
+			counts->freefalls += delta;
+			break;
+		case FIELD_TYPE_COLLECTIBLE:
+			counts->collectibles += delta;
+			counts->collectible[subtype] += delta;
+			break;
+		case FIELD_TYPE_ANIMAL:
+			counts->animal[subtype] += delta;
+			if (sleeping) {
+				counts->sleeping += delta;
+			}
+			if (super) {
+				counts->super += delta;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+void UpdateFieldCounts(struct Game* game, struct GamestateResources* data, struct Field* field) {
+	if (field->counted.valid) {
+		CountField(&data->counts, field->counted.type, field->counted.subtype, field->counted.sleeping, field->counted.super, -1);
+	}
+	field->counted.valid = true;
+	field->counted.type = field->type;
+	field->counted.subtype = 0;
+	field->counted.sleeping = false;
+	field->counted.super = false;
+	if (field->type == FIELD_TYPE_ANIMAL) {
+		field->counted.subtype = field->data.animal.type;
+		field->counted.sleeping = field->data.animal.sleeping;
+		field->counted.super = field->data.animal.super;
+	} else if (field->type == FIELD_TYPE_COLLECTIBLE) {
+		field->counted.subtype = field->data.collectible.type;
+	}
+	CountField(&data->counts, field->counted.type, field->counted.subtype, field->counted.sleeping, field->counted.super, 1);
+}
+
+struct FieldCounts CountFields(struct Game* game, struct GamestateResources* data) {
+	struct FieldCounts counts = {0};
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
+			struct Field* field = &data->fields[i][j];
+			if (field->type == FIELD_TYPE_ANIMAL) {
+				CountField(&counts, field->type, field->data.animal.type, field->data.animal.sleeping, field->data.animal.super, 1);
+			} else if (field->type == FIELD_TYPE_COLLECTIBLE) {
+				CountField(&counts, field->type, field->data.collectible.type, false, false, 1);
+			} else {
+				CountField(&counts, field->type, 0, false, false, 1);
+			}
+		}
+	}
+	return counts;
+}
+
+static unsigned int MatchingAnimals(struct Game* game, struct GamestateResources* data, struct FieldID id) {
+	// bitmask of animal types that would complete a line of three when placed at id
+	struct FieldID (*callbacks[])(struct FieldID) = {ToLeft, ToRight, ToTop, ToBottom};
+	int types[4], runs[4];
+	for (int d = 0; d < 4; d++) {
+		types[d] = -1;
+		runs[d] = 0;
+		struct FieldID pos = callbacks[d](id);
+		while (runs[d] < 2 && IsValidID(pos)) {
+			struct Field* field = GetField(game, data, pos);
+			if (field->type != FIELD_TYPE_ANIMAL || IsSleeping(field)) {
+				break;
+			}
+			if (runs[d] && (int)field->data.animal.type != types[d]) {
+				break;
+			}
+			types[d] = field->data.animal.type;
+			runs[d]++;
+			pos = callbacks[d](pos);
+		}
+	}
+
+	unsigned int mask = 0;
+	for (int d = 0; d < 4; d += 2) {
+		if (runs[d] >= 2) {
+			mask |= 1u << types[d];
+		}
+		if (runs[d + 1] >= 2) {
+			mask |= 1u << types[d + 1];
+		}
+		if (runs[d] && runs[d + 1] && types[d] == types[d + 1]) {
+			mask |= 1u << types[d];
+		}
+	}
+	return mask;
+}
+
+void GenerateAnimal(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches) {
+	field->type = FIELD_TYPE_ANIMAL;
+	field->data.animal.sleeping = false;
+	field->data.animal.super = false;
+
+	if (data->level.field_types[FIELD_TYPE_ANIMAL]) {
+		unsigned int matching = allow_matches ? 0 : MatchingAnimals(game, data, field->id);
+		enum ANIMAL_TYPE allowed[ANIMAL_TYPES];
+		int count = 0;
+		for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
+			if (data->level.animals[type] && !(matching & (1u << type))) {
+				allowed[count++] = type;
+			}
+		}
+		if (!count) {
+			// every enabled animal would make a match here, so there's no way to avoid it
+			for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
+				if (data->level.animals[type]) {
+					allowed[count++] = type;
+				}
+			}
+		}
+		if (count) {
+			field->data.animal.type = allowed[RollRandom(data) % count];
+		}
+	}
+
+	if (RollRandom(data) / (float)RAND_MAX < 0.005) {
+		field->data.animal.sleeping = data->level.sleeping;
+	}
+
+	field->overlay_visible = false;
+	field->locked = true;
+	UpdateDrawable(game, data, field->id);
+	UpdateFieldHash(game, data, field);
+}
+
+static void GenerateCollectible(struct Game* game, struct GamestateResources* data, struct Field* field, bool need_type[]) {
+	field->type = FIELD_TYPE_COLLECTIBLE;
+	field->data.collectible.variant = 0;
+
+	// compensate for missing fields needed to reach the goals / requirements
+	for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
+		if (need_type[type]) {
+			field->data.collectible.type = type;
+			return;
+		}
+	}
+
+	enum COLLECTIBLE_TYPE allowed[COLLECTIBLE_TYPES];
+	int count = 0;
+	for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
+		if (data->level.collectibles[type]) {
+			allowed[count++] = type;
+		}
+	}
+	if (!count) {
+		// only required by a generic collectible goal, so any of them will do
+		for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
+			allowed[count++] = type;
+		}
+	}
+	field->data.collectible.type = allowed[RollRandom(data) % count];
+}
+
+void GenerateField(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches) {
+	bool need_collectible = false, need_freefall = false, need_sleeping = false, need_animal = false, need_super = false,
+			 need_animal_type[ANIMAL_TYPES] = {}, need_collectible_type[COLLECTIBLE_TYPES] = {};
+	struct FieldCounts* counts = &data->counts;
+
+	for (int i = 0; i < 3; i++) {
+		if (data->goals[i].value <= 0) {
+			continue;
+		}
+
+		if (data->goals[i].type == GOAL_TYPE_FREEFALL) {
+			if (counts->freefalls == 0) {
+				need_freefall = true;
+			}
+		} else if (data->goals[i].type == GOAL_TYPE_COLLECTIBLE) {
+			if (counts->collectibles == 0) {
+				need_collectible = true;
+			}
+		}
+
+		for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
+			if ((data->goals[i].type - GOAL_TYPE_COLLECTIBLE - 1) == type) {
+				if (counts->collectible[type] == 0) {
+					need_collectible = true;
+					need_collectible_type[type] = true;
+				}
+			}
+		}
+	}
+
+	if (counts->freefalls < data->requirements[GOAL_TYPE_FREEFALL]) {
+		need_freefall = true;
+	}
+	if (counts->collectibles < data->requirements[GOAL_TYPE_COLLECTIBLE]) {
+		need_collectible = true;
+	}
+	if (counts->sleeping < data->requirements[GOAL_TYPE_SLEEPING]) {
+		need_sleeping = true;
+	}
+	if (counts->super < data->requirements[GOAL_TYPE_SUPER]) {
+		need_super = true;
+	}
+	for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
+		if (counts->collectible[type] < data->requirements[type + GOAL_TYPE_COLLECTIBLE + 1]) {
+			need_collectible = true;
+			need_collectible_type[type] = true;
+		}
+	}
+	for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
+		if (counts->animal[type] < data->requirements[type + GOAL_TYPE_ANIMAL + 1]) {
+			need_animal = true;
+			need_animal_type[type] = true;
+		}
+	}
+
+	// Field kinds are rolled in order (freefall, then collectible, then animal) and
+	// disallowed outcomes get rerolled, so each allowed kind ends up being picked
+	// with its chance of being rolled first, normalized over all allowed ones.
+	double freefall = need_freefall ? 0.5 : 0.001, collectible = (1.0 - freefall) * (need_collectible ? 0.5 : 0.01),
+				 animal = 1.0 - freefall - collectible;
+	if (!need_freefall && !data->level.field_types[FIELD_TYPE_FREEFALL]) {
+		freefall = 0;
+	}
+	if (!need_collectible && !data->level.field_types[FIELD_TYPE_COLLECTIBLE]) {
+		collectible = 0;
+	}
+	if (!need_animal && !data->level.field_types[FIELD_TYPE_ANIMAL] && (freefall || collectible)) {
+		animal = 0;
+	}
+
+	double roll = RollRandom(data) / (double)RAND_MAX * (freefall + collectible + animal);
+	if (roll < freefall) {
+		field->type = FIELD_TYPE_FREEFALL;
+		field->data.freefall.variant = RollRandom(data) % SPECIAL_ACTIONS[SPECIAL_TYPE_EGG].actions;
+	} else if (roll < freefall + collectible) {
+		GenerateCollectible(game, data, field, need_collectible_type);
+	} else {
+		GenerateAnimal(game, data, field, allow_matches);
+		field->data.animal.super = need_super;
+		if (!field->data.animal.super) {
+			if (need_sleeping) {
+				field->data.animal.sleeping = true;
+			}
+		}
+
+		// compensate for missing fields needed to reach the goals / requirements
+		for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
+			if (need_animal_type[type]) {
+				field->data.animal.type = type;
+				break;
+			}
+		}
+	}
+
+	field->overlay_visible = false;
+	field->locked = true;
+	UpdateDrawable(game, data, field->id);
+	UpdateFieldHash(game, data, field);
+}
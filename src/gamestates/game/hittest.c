@@ -0,0 +1,152 @@
+/*! \file hittest.c
+ *  \brief Finding what's under the pointer.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * Pixel-perfect tests against characters are costly, so the screen is split
+ * into a coarse grid that remembers which interactive elements may be found in
+ * each of its cells. Only those get tested for real, so most pointer events
+ * (especially the ones over the board) don't test anything at all.
+ *
+ * The grid is built from the boxes the elements occupy when at rest, which
+ * are known from the layout, so building it doesn't have to touch the
+ * characters themselves. The UI elements share a single screen-sized sheet,
+ * so their boxes come from the placement of their own frames in it. Every box
+ * gets spread by one more cell to cover elements that move or rotate a bit on
+ * their own. The restart button slides in from the top, so its whole path
+ * gets marked.
+ *
+ * The grid gets rebuilt on first use after UpdateLayout invalidates it.
+ */
+
+#define HIT_GRID_SIZE 40
+
+struct HitBox {
+	float x, y, w, h;
+};
+
+static struct HitBox GetFrameBox(struct Character* character, int frame) {
+	struct SpritesheetFrame* f = &character->spritesheet->frames[frame];
+	return (struct HitBox){f->x, f->y, al_get_bitmap_width(f->bitmap), al_get_bitmap_height(f->bitmap)};
+}
+
+static struct HitBox GetRestBox(struct GamestateResources* data, enum HIT_TARGET target) {
+	// the same places Gamestate_Draw and DrawScene put them at, minus the animations
+	switch (target) {
+		case HIT_TARGET_RESTART:
+			return (struct HitBox){440, 780 - (508 + 410), 169, 175 + 508 + 410};
+		case HIT_TARGET_BEETLE:
+			return (struct HitBox){0, 1194, 246, 246}; // see beetle.ini
+		case HIT_TARGET_ACORN_TOP:
+			return (struct HitBox){209, 240, 102, 105};
+		case HIT_TARGET_ACORN_BOTTOM:
+			return (struct HitBox){261, 1094 - 16, 165, 145 + 16};
+		case HIT_TARGET_HINT:
+			return GetFrameBox(data->ui, UI_ELEMENT_HINT);
+		case HIT_TARGET_HOME:
+			return GetFrameBox(data->ui, UI_ELEMENT_HOME);
+		default:
+			return (struct HitBox){0, 0, 0, 0};
+	}
+}
+
+static bool IsOnTarget(struct Game* game, struct GamestateResources* data, enum HIT_TARGET target, float x, float y) {
+	switch (target) {
+		case HIT_TARGET_RESTART:
+			return IsOnCharacter(game, data->restart_btn, x, y, true);
+		case HIT_TARGET_BEETLE:
+			return IsOnCharacter(game, data->beetle, x, y, true);
+		case HIT_TARGET_ACORN_TOP:
+			return IsOnCharacter(game, data->acorn_top.character, x, y, true);
+		case HIT_TARGET_ACORN_BOTTOM:
+			return IsOnCharacter(game, data->acorn_bottom.character, x, y, true);
+		case HIT_TARGET_HINT:
+			return IsOnUIElement(game, data->ui, UI_ELEMENT_HINT, x, y);
+		case HIT_TARGET_HOME:
+			return IsOnUIElement(game, data->ui, UI_ELEMENT_HOME, x, y);
+		default:
+			return false;
+	}
+}
+
+static void BuildHitGrid(struct Game* game, struct GamestateResources* data) {
+	data->hit.cols = (game->viewport.width + HIT_GRID_SIZE - 1) / HIT_GRID_SIZE;
+	data->hit.rows = (game->viewport.height + HIT_GRID_SIZE - 1) / HIT_GRID_SIZE;
+	free(data->hit.cells);
+	data->hit.cells = calloc(data->hit.cols * data->hit.rows, sizeof(uint8_t));
+
+	for (enum HIT_TARGET target = 0; target < HIT_TARGETS; target++) {
+		struct HitBox box = GetRestBox(data, target);
+		// spread by one cell on each side
+		int left = (int)floor(box.x / HIT_GRID_SIZE) - 1, right = (int)floor((box.x + box.w) / HIT_GRID_SIZE) + 1;
+		int top = (int)floor(box.y / HIT_GRID_SIZE) - 1, bottom = (int)floor((box.y + box.h) / HIT_GRID_SIZE) + 1;
+		for (int i = fmax(left, 0); i <= right && i < data->hit.cols; i++) {
+			for (int j = fmax(top, 0); j <= bottom && j < data->hit.rows; j++) {
+				data->hit.cells[j * data->hit.cols + i] |= 1u << target;
+			}
+		}
+	}
+
+	data->hit.valid = true;
+}
+
+bool IsOnHitTarget(struct Game* game, struct GamestateResources* data, enum HIT_TARGET target, float x, float y) {
+	if (!data->hit.valid) {
+		BuildHitGrid(game, data);
+	}
+	int i = (int)floor(x / HIT_GRID_SIZE), j = (int)floor(y / HIT_GRID_SIZE);
+	if (i < 0 || j < 0 || i >= data->hit.cols || j >= data->hit.rows) {
+		return false;
+	}
+	if (!(data->hit.cells[j * data->hit.cols + i] & (1u << target))) {
+		return false;
+	}
+	return IsOnTarget(game, data, target, x, y);
+}
+
+struct FieldID GetFieldAt(struct Game* game, struct GamestateResources* data, float x, float y) {
+	struct FieldID id = {.i = (int)floor((x - data->cell.x) / data->cell.size), .j = (int)floor((y - data->cell.y) / data->cell.size)};
+	if ((id.i < 0) || (id.j < 0) || (id.i >= data->cols) || (id.j >= data->rows)) {
+		return (struct FieldID){-1, -1};
+	}
+	return id;
+}
+
+struct FieldID GetSwipeTarget(struct Game* game, struct GamestateResources* data, struct FieldID from, float x, float y) {
+	// Motion events get coalesced (see CoalesceMotion in common.c), so a quick swipe can
+	// land a few fields away by the time it gets processed. As long as it went straight
+	// along a row or a column, it's still meant as a swap with the neighbour.
+	int i = (int)floor((x - data->cell.x) / data->cell.size), j = (int)floor((y - data->cell.y) / data->cell.size);
+	if ((i == from.i) != (j == from.j)) {
+		struct FieldID id = {from.i + (i > from.i) - (i < from.i), from.j + (j > from.j) - (j < from.j)};
+		if ((id.i < 0) || (id.j < 0) || (id.i >= data->cols) || (id.j >= data->rows)) {
+			return (struct FieldID){-1, -1};
+		}
+		return id;
+	}
+	return GetFieldAt(game, data, x, y);
+}
+
+void DestroyHitGrid(struct Game* game, struct GamestateResources* data) {
+	free(data->hit.cells);
+	data->hit.cells = NULL;
+	data->hit.valid = false;
+}
@@ -0,0 +1,161 @@
+/*! \file idle.c
+ *  \brief Scheduling of idle animations of the fields.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * Every field remembers when (on the idle clock, in milliseconds) it's going to
+ * start its next random action or blink, or when the one it's currently busy
+ * with ends. Board positions are kept in a min-heap ordered by the nearest of
+ * those, so each tick only deals with the fields whose time has come.
+ *
+ * The timers belong to the field, so they travel with it when it gets swapped.
+ * Swap keeps the heap in sync by exchanging the positions stored in it, which
+ * doesn't change the order of the keys.
+ *
+ * Fields that can't animate right now (sleeping, not drawable or with reduced
+ * movement enabled) have their timers postponed by IDLE_RECHECK_TIME whenever
+ * they come up, which mostly keeps them paused like they used to be.
+ */
+
+#define IDLE_RECHECK_TIME 1000
+
+static int64_t NextIdleEvent(struct Field* field) {
+	if (field->animation.busy) {
+		return field->animation.busy_until;
+	}
+	return field->animation.action_at < field->animation.blink_at ? field->animation.action_at : field->animation.blink_at;
+}
+
+static int64_t HeapKey(struct GamestateResources* data, int n) {
+	struct FieldID id = data->idle.heap[n];
+	return NextIdleEvent(&data->fields[id.i][id.j]);
+}
+
+static void HeapSwap(struct GamestateResources* data, int a, int b) {
+	struct FieldID tmp = data->idle.heap[a];
+	data->idle.heap[a] = data->idle.heap[b];
+	data->idle.heap[b] = tmp;
+	data->idle.index[data->idle.heap[a].i][data->idle.heap[a].j] = a;
+	data->idle.index[data->idle.heap[b].i][data->idle.heap[b].j] = b;
+}
+
+static void SiftDown(struct GamestateResources* data, int n) {
+	while (true) {
+		int smallest = n, left = 2 * n + 1, right = 2 * n + 2;
+		if (left < data->idle.count && HeapKey(data, left) < HeapKey(data, smallest)) {
+			smallest = left;
+		}
+		if (right < data->idle.count && HeapKey(data, right) < HeapKey(data, smallest)) {
+			smallest = right;
+		}
+		if (smallest == n) {
+			return;
+		}
+		HeapSwap(data, n, smallest);
+		n = smallest;
+	}
+}
+
+static void StartBusy(struct GamestateResources* data, struct Field* field, int duration) {
+	// idle countdowns don't run while the field is busy
+	field->animation.busy = true;
+	field->animation.busy_until = data->idle.clock + duration;
+	field->animation.action_at += duration;
+	field->animation.blink_at += duration;
+}
+
+static void HandleIdleEvent(struct Game* game, struct GamestateResources* data, struct Field* field) {
+	int64_t clock = data->idle.clock;
+
+	if (game->data->config.less_movement || IsSleeping(field) || !IsDrawable(field->type)) {
+		field->animation.action_at += IDLE_RECHECK_TIME;
+		field->animation.blink_at += IDLE_RECHECK_TIME;
+		field->animation.busy_until += IDLE_RECHECK_TIME;
+		return;
+	}
+
+	if (field->animation.busy) {
+		field->animation.busy = false;
+		if (field->type == FIELD_TYPE_ANIMAL) {
+			SelectAnimalSpritesheet(game, data, field, ANIMAL_SPRITESHEET_STAND);
+		}
+		return;
+	}
+
+	if (field->animation.action_at <= clock) {
+		field->animation.action_at = clock + rand() % 250000 + 500000;
+		if (field->type == FIELD_TYPE_ANIMAL) {
+			SelectRandomAnimalAction(game, data, field);
+		}
+		StartBusy(data, field, rand() % 2000 + 1000);
+		return;
+	}
+
+	if (field->animation.blink_at <= clock) {
+		bool standing = IsStanding(game, data, field);
+		field->animation.blink_at = clock + rand() % 100000 + 200000;
+		if (standing) {
+			if (field->type == FIELD_TYPE_ANIMAL) {
+				SelectAnimalSpritesheet(game, data, field, ANIMAL_SPRITESHEET_BLINK);
+			}
+			StartBusy(data, field, rand() % 400 + 100);
+		}
+	}
+}
+
+void ResetIdleAnimations(struct Game* game, struct GamestateResources* data) {
+	data->idle.count = 0;
+	for (int i = 0; i < MAX_COLS; i++) {
+		for (int j = 0; j < MAX_ROWS; j++) {
+			struct Field* field = &data->fields[i][j];
+			field->animation.action_at = data->idle.clock + (int)((rand() % 250000 + 500000) * (rand() / (double)RAND_MAX));
+			field->animation.blink_at = data->idle.clock + (int)((rand() % 100000 + 200000) * (rand() / (double)RAND_MAX));
+			field->animation.busy = false;
+			data->idle.index[i][j] = -1;
+			if (i < data->cols && j < data->rows) {
+				data->idle.index[i][j] = data->idle.count;
+				data->idle.heap[data->idle.count++] = field->id;
+			}
+		}
+	}
+	for (int n = data->idle.count / 2 - 1; n >= 0; n--) {
+		SiftDown(data, n);
+	}
+}
+
+void UpdateIdleAnimations(struct Game* game, struct GamestateResources* data, double delta) {
+	// truncating every delta on its own would make the clock fall behind
+	data->idle.time += delta;
+	data->idle.clock = (int64_t)(data->idle.time * 1000);
+	while (data->idle.count && HeapKey(data, 0) <= data->idle.clock) {
+		struct FieldID id = data->idle.heap[0];
+		HandleIdleEvent(game, data, &data->fields[id.i][id.j]);
+		SiftDown(data, 0);
+	}
+}
+
+void SwapIdleAnimations(struct GamestateResources* data, struct FieldID one, struct FieldID two) {
+	int a = data->idle.index[one.i][one.j], b = data->idle.index[two.i][two.j];
+	if (a < 0 || b < 0) {
+		return;
+	}
+	HeapSwap(data, a, b);
+}
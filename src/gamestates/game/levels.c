@@ -20,6 +20,19 @@
 
 #include "game.h"
 
+static void SetLevelSize(struct GamestateResources* data, int cols, int rows) {
+	data->level.cols = cols;
+	data->level.rows = rows;
+	for (int i = 0; i < MAX_COLS; i++) {
+		for (int j = 0; j < MAX_ROWS; j++) {
+			if (i >= cols || j >= rows) {
+				memset(&data->level.fields[i][j], 0, sizeof(data->level.fields[i][j]));
+				data->level.fields[i][j].field_type = FIELD_TYPE_DISABLED;
+			}
+		}
+	}
+}
+
 void LoadLevel(struct Game* game, struct GamestateResources* data, int id) {
 	if (id == 0) {
 		// infinite level
@@ -43,10 +56,11 @@ void LoadLevel(struct Game* game, struct GamestateResources* data, int id) {
 		data->level.goals[1].type = GOAL_TYPE_NONE;
 		data->level.goals[2].type = GOAL_TYPE_NONE;
 
-		for (int i = 0; i < COLS; i++) {
-			for (int j = 0; j < ROWS; j++) {
+		SetLevelSize(data, DEFAULT_COLS, DEFAULT_ROWS);
+		for (int i = 0; i < data->level.cols; i++) {
+			for (int j = 0; j < data->level.rows; j++) {
 				data->level.fields[i][j].field_type = FIELD_TYPE_ANIMAL;
-				data->level.fields[i][j].animal_type = (j * COLS + i) % ANIMAL_TYPES;
+				data->level.fields[i][j].animal_type = (j * MAX_COLS + i) % ANIMAL_TYPES;
 				data->level.fields[i][j].random_subtype = true;
 				data->level.fields[i][j].sleeping = false;
 				data->level.fields[i][j].super = false;
@@ -191,19 +205,20 @@ void LoadLevel(struct Game* game, struct GamestateResources* data, int id) {
 	data->level.supers = al_fread16le(file);
 	data->level.sleeping = al_fread16le(file);
 
-	val = al_fread16le(file);
-	if (val != ROWS) {
-		FatalError(game, false, "Invalid number of rows (%d) in level data: %s", val, filename);
+	int rows = al_fread16le(file);
+	if (rows < MIN_ROWS || rows > MAX_ROWS) {
+		FatalError(game, false, "Invalid number of rows (%d) in level data: %s", rows, filename);
 		goto err;
 	}
-	val = al_fread16le(file);
-	if (val != COLS) {
-		FatalError(game, false, "Invalid number of cols (%d) in level data: %s", val, filename);
+	int cols = al_fread16le(file);
+	if (cols < MIN_COLS || cols > MAX_COLS) {
+		FatalError(game, false, "Invalid number of cols (%d) in level data: %s", cols, filename);
 		goto err;
 	}
 
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	SetLevelSize(data, cols, rows);
+	for (int i = 0; i < data->level.cols; i++) {
+		for (int j = 0; j < data->level.rows; j++) {
 			data->level.fields[i][j].field_type = al_fread16le(file);
 
 			switch (data->level.fields[i][j].field_type) {
@@ -246,8 +261,9 @@ void CopyLevel(struct Game* game, struct GamestateResources* data) {
 		data->level.requirements[i] = data->requirements[i];
 	}
 
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	SetLevelSize(data, data->cols, data->rows);
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			data->level.fields[i][j].field_type = data->fields[i][j].type;
 
 			switch (data->level.fields[i][j].field_type) {
@@ -268,8 +284,8 @@ void CopyLevel(struct Game* game, struct GamestateResources* data) {
 }
 
 void StartLevel(struct Game* game, struct GamestateResources* data) {
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			if (data->level.fields[i][j].field_type == FIELD_TYPE_EMPTY) {
 				GenerateField(game, data, &data->fields[i][j], false);
 			}
@@ -285,13 +301,10 @@ void StartLevel(struct Game* game, struct GamestateResources* data) {
 }
 
 void ApplyLevel(struct Game* game, struct GamestateResources* data) {
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < MAX_COLS; i++) {
+		for (int j = 0; j < MAX_ROWS; j++) {
 			data->fields[i][j].animation.hiding = StaticTween(game, 0.0);
 			data->fields[i][j].animation.falling = StaticTween(game, 1.0);
-
-			data->fields[i][j].animation.time_to_action = (int)((rand() % 250000 + 500000) * (rand() / (double)RAND_MAX));
-			data->fields[i][j].animation.time_to_blink = (int)((rand() % 100000 + 200000) * (rand() / (double)RAND_MAX));
 		}
 	}
 
@@ -308,9 +321,17 @@ void ApplyLevel(struct Game* game, struct GamestateResources* data) {
 			data->requirements[i] = data->level.requirements[i];
 		}
 
-		for (int i = 0; i < COLS; i++) {
-			for (int j = 0; j < ROWS; j++) {
+		data->cols = data->level.cols;
+		data->rows = data->level.rows;
+		UpdateLayout(game, data);
+
+		for (int i = 0; i < MAX_COLS; i++) {
+			for (int j = 0; j < MAX_ROWS; j++) {
 				data->fields[i][j].type = data->level.fields[i][j].field_type;
+				if (i >= data->cols || j >= data->rows) {
+					// everything outside of the board is disabled, so neighbour lookups never leave it
+					data->fields[i][j].type = FIELD_TYPE_DISABLED;
+				}
 
 				switch (data->level.fields[i][j].field_type) {
 					case FIELD_TYPE_COLLECTIBLE:
@@ -333,6 +354,7 @@ void ApplyLevel(struct Game* game, struct GamestateResources* data) {
 						break;
 				}
 				UpdateDrawable(game, data, data->fields[i][j].id);
+				UpdateFieldHash(game, data, &data->fields[i][j]);
 			}
 		}
 		data->moves = 0;
@@ -344,6 +366,9 @@ void ApplyLevel(struct Game* game, struct GamestateResources* data) {
 	}
 
 	data->current = (struct FieldID){-1, -1};
+	ResetIdleAnimations(game, data);
+	data->turn.running = false;
+	data->queued.valid = false;
 }
 
 void RestartLevel(struct Game* game, struct GamestateResources* data) {
@@ -352,8 +377,8 @@ void RestartLevel(struct Game* game, struct GamestateResources* data) {
 	data->failed = false;
 	data->failing = StaticTween(game, 0.0);
 	data->locked = false;
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			SpawnParticles(game, data, (struct FieldID){i, j}, 16);
 		}
 	}
@@ -400,8 +425,8 @@ void SanityCheckLevel(struct Game* game, struct GamestateResources* data) {
 void FinishLevel(struct Game* game, struct GamestateResources* data) {
 	data->done = true;
 	data->finishing = Tween(game, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, 1.0);
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			SpawnParticles(game, data, (struct FieldID){i, j}, 16);
 		}
 	}
@@ -480,10 +505,10 @@ void StoreLevel(struct Game* game, struct GamestateResources* data) {
 	al_fwrite16le(file, data->level.supers);
 	al_fwrite16le(file, data->level.sleeping);
 
-	al_fwrite16le(file, ROWS);
-	al_fwrite16le(file, COLS);
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	al_fwrite16le(file, data->level.rows);
+	al_fwrite16le(file, data->level.cols);
+	for (int i = 0; i < data->level.cols; i++) {
+		for (int j = 0; j < data->level.rows; j++) {
 			al_fwrite16le(file, data->level.fields[i][j].field_type);
 			switch (data->level.fields[i][j].field_type) {
 				case FIELD_TYPE_ANIMAL:
@@ -34,8 +34,9 @@
  *    - if necessary, Collect and AnimateSpecials are repeated as long as there's something to do for them
  *    - now:
  *      - if something happened earlier, DispatchAnimations is queued after any previously queued animation
- *      - if nothing happened and there are no possible moves left, HandleDeadlock is called which is supposed
- *        to shuffle the board in order to get out of deadlock; DispatchAnimations is then queued
+ *      - if nothing happened and there are no possible moves left, ShuffleAnimals rearranges the animals
+ *        to get out of deadlock; only if that fails, HandleDeadlock removes some of them and
+ *        DispatchAnimations is queued
  *      - otherwise, the controls are unlocked, goals/turns checked and the execution flow stops there.
  *
  *  - DispatchAnimations does two things:
@@ -48,8 +49,27 @@
  *    - and goes back to ProcessFields, which may handle combos now, or may just stop if there are none.
  *
  *  (routine naming is hard...)
+ *
+ *  The rules only ever run here, on the timeline. What the turn is going to end with is predicted
+ *  up front by PredictTurn, see turn.c.
  */
 
+static void AnimateField(struct Game* game, struct GamestateResources* data, struct FieldID id) {
+	// lists the field for UpdateFieldAnimations, so its tweens get updated until they're done
+	if (!IsValidID(id) || data->animating.listed[id.i][id.j]) {
+		return;
+	}
+	data->animating.listed[id.i][id.j] = true;
+	data->animating.ids[data->animating.count++] = id;
+}
+
+struct Tween* StartFieldTween(struct Game* game, struct GamestateResources* data, struct Field* field, struct Tween* tween, double start, double stop, enum TWEEN_STYLE style, double duration) {
+	// all of the field's tweens have to be started through here, otherwise nothing updates them
+	*tween = Tween(game, start, stop, style, duration);
+	AnimateField(game, data, field->id);
+	return tween;
+}
+
 void UpdateGoal(struct Game* game, struct GamestateResources* data, enum GOAL_TYPE type, int val) {
 	if (data->goal_lock) {
 		return;
@@ -71,7 +91,7 @@ void AddScore(struct Game* game, struct GamestateResources* data, int val) {
 	UpdateGoal(game, data, GOAL_TYPE_SCORE, val);
 }
 
-static bool CheckGoals(struct Game* game, struct GamestateResources* data) {
+bool CheckGoals(struct Game* game, struct GamestateResources* data) {
 	if (data->infinite) {
 		return false;
 	}
@@ -87,8 +107,8 @@ static bool CheckGoals(struct Game* game, struct GamestateResources* data) {
 
 int MarkMatching(struct Game* game, struct GamestateResources* data) {
 	int matching = 0;
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			data->fields[i][j].matched = IsMatching(game, data, (struct FieldID){i, j});
 			if (data->fields[i][j].matched) {
 				data->fields[i][j].to_remove = true;
@@ -101,14 +121,14 @@ int MarkMatching(struct Game* game, struct GamestateResources* data) {
 	return matching;
 }
 
-static int Collect(struct Game* game, struct GamestateResources* data) {
+int Collect(struct Game* game, struct GamestateResources* data) {
 	int collected = 0;
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			if (data->fields[i][j].type == FIELD_TYPE_FREEFALL) {
 				bool to_collect = true;
 				int a = j + 1;
-				while (a < ROWS) {
+				while (a < data->rows) {
 					if (data->fields[i][a].type != FIELD_TYPE_DISABLED) {
 						to_collect = false;
 						break;
@@ -129,7 +149,8 @@ static int Collect(struct Game* game, struct GamestateResources* data) {
 					data->fields[i][j].to_remove = false;
 					data->fields[i][j].handled = true;
 					UpdateDrawable(game, data, data->fields[i][j].id);
-					data->fields[i][j].animation.collecting = Tween(game, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, COLLECTING_TIME);
+					UpdateFieldHash(game, data, &data->fields[i][j]);
+					StartFieldTween(game, data, &data->fields[i][j], &data->fields[i][j].animation.collecting, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, COLLECTING_TIME);
 					data->fields[i][j].to_highlight = true;
 					collected++;
 					AddScore(game, data, 10);
@@ -148,7 +169,8 @@ static int Collect(struct Game* game, struct GamestateResources* data) {
 						AddScore(game, data, 20);
 					}
 					UpdateDrawable(game, data, data->fields[i][j].id);
-					data->fields[i][j].animation.collecting = Tween(game, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, COLLECTING_TIME);
+					UpdateFieldHash(game, data, &data->fields[i][j]);
+					StartFieldTween(game, data, &data->fields[i][j], &data->fields[i][j].animation.collecting, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, COLLECTING_TIME);
 					data->fields[i][j].handled = true;
 					data->fields[i][j].to_highlight = true;
 					collected++;
@@ -161,176 +183,19 @@ static int Collect(struct Game* game, struct GamestateResources* data) {
 	return collected;
 }
 
-void GenerateAnimal(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches) {
-	field->type = FIELD_TYPE_ANIMAL;
-	while (data->level.field_types[FIELD_TYPE_ANIMAL]) {
-		field->data.animal.type = rand() % ANIMAL_TYPES;
-		if (!allow_matches && IsMatching(game, data, field->id)) {
-			continue;
-		}
-		if (data->level.animals[field->data.animal.type]) {
-			break;
-		}
-	}
-	field->data.animal.sleeping = false;
-	field->data.animal.super = false;
-
-	if (rand() / (float)RAND_MAX < 0.005) {
-		field->data.animal.sleeping = data->level.sleeping;
-	}
-
-	field->overlay_visible = false;
-	field->locked = true;
-	UpdateDrawable(game, data, field->id);
-}
-
-void GenerateField(struct Game* game, struct GamestateResources* data, struct Field* field, bool allow_matches) {
-	bool need_collectible = false, need_freefall = false, need_sleeping = false, need_animal = false, need_super = false,
-			 need_animal_type[ANIMAL_TYPES] = {}, need_collectible_type[COLLECTIBLE_TYPES] = {};
-	int collectibles = 0, freefalls = 0, sleeping = 0, super = 0,
-			collectible[COLLECTIBLE_TYPES] = {}, animal[ANIMAL_TYPES] = {};
-	for (int i = 0; i < ROWS; i++) {
-		for (int j = 0; j < COLS; j++) {
-			if (data->fields[i][j].type == FIELD_TYPE_FREEFALL) {
-				freefalls++;
-			} else if (data->fields[i][j].type == FIELD_TYPE_COLLECTIBLE) {
-				collectibles++;
-				collectible[data->fields[i][j].data.collectible.type]++;
-			} else if (data->fields[i][j].type == FIELD_TYPE_ANIMAL) {
-				animal[data->fields[i][j].data.animal.type]++;
-				if (data->fields[i][j].data.animal.sleeping) {
-					sleeping++;
-				}
-				if (data->fields[i][j].data.animal.super) {
-					super++;
-				}
-			}
-		}
-	}
-
-	for (int i = 0; i < 3; i++) {
-		if (data->goals[i].value <= 0) {
-			continue;
-		}
-
-		if (data->goals[i].type == GOAL_TYPE_FREEFALL) {
-			if (freefalls == 0) {
-				need_freefall = true;
-			}
-		} else if (data->goals[i].type == GOAL_TYPE_COLLECTIBLE) {
-			if (collectibles == 0) {
-				need_collectible = true;
-			}
-		}
-
-		for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
-			if ((data->goals[i].type - GOAL_TYPE_COLLECTIBLE - 1) == type) {
-				if (collectible[type] == 0) {
-					need_collectible = true;
-					need_collectible_type[type] = true;
-				}
-			}
-		}
-	}
-
-	if (freefalls < data->requirements[GOAL_TYPE_FREEFALL]) {
-		need_freefall = true;
-	}
-	if (collectibles < data->requirements[GOAL_TYPE_COLLECTIBLE]) {
-		need_collectible = true;
-	}
-	if (sleeping < data->requirements[GOAL_TYPE_SLEEPING]) {
-		need_sleeping = true;
-	}
-	if (super < data->requirements[GOAL_TYPE_SUPER]) {
-		need_super = true;
-	}
-	for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
-		if (collectible[type] < data->requirements[type + GOAL_TYPE_COLLECTIBLE + 1]) {
-			need_collectible = true;
-			need_collectible_type[type] = true;
-		}
-	}
-	for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
-		if (animal[type] < data->requirements[type + GOAL_TYPE_ANIMAL + 1]) {
-			need_animal = true;
-			need_animal_type[type] = true;
-		}
-	}
-
-	while (true) {
-		if (rand() / (float)RAND_MAX < (need_freefall ? 0.5 : 0.001)) {
-			field->type = FIELD_TYPE_FREEFALL;
-			field->data.freefall.variant = rand() % SPECIAL_ACTIONS[SPECIAL_TYPE_EGG].actions;
-			if (need_freefall || data->level.field_types[FIELD_TYPE_FREEFALL]) {
-				break;
-			}
-		} else if (rand() / (float)RAND_MAX < (need_collectible ? 0.5 : 0.01)) {
-			field->type = FIELD_TYPE_COLLECTIBLE;
-			field->data.collectible.variant = 0;
-			bool set = false;
-			if (need_collectible) {
-				// compensate for missing fields needed to reach the goals / requirements
-				for (enum COLLECTIBLE_TYPE type = 0; type < COLLECTIBLE_TYPES; type++) {
-					if (need_collectible_type[type]) {
-						field->data.collectible.type = type;
-						set = true;
-						break;
-					}
-				}
-			}
-			if (set) {
-				break;
-			}
-			while (data->level.field_types[FIELD_TYPE_COLLECTIBLE]) {
-				field->data.collectible.type = rand() % COLLECTIBLE_TYPES;
-				if (data->level.collectibles[field->data.collectible.type]) {
-					break;
-				}
-			}
-			if (need_collectible || data->level.field_types[FIELD_TYPE_COLLECTIBLE]) {
-				break;
-			}
-		} else {
-			GenerateAnimal(game, data, field, allow_matches);
-			field->data.animal.super = need_super;
-			if (!field->data.animal.super) {
-				if (need_sleeping) {
-					field->data.animal.sleeping = true;
-				}
-			}
-
-			// compensate for missing fields needed to reach the goals / requirements
-			for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
-				if (need_animal_type[type]) {
-					field->data.animal.type = type;
-					break;
-				}
-			}
-
-			if (need_animal || data->level.field_types[FIELD_TYPE_ANIMAL]) {
-				break;
-			}
-		}
-	}
-	field->overlay_visible = false;
-	field->locked = true;
-	UpdateDrawable(game, data, field->id);
-}
-
 static void CreateNewField(struct Game* game, struct GamestateResources* data, struct Field* field) {
 	GenerateField(game, data, field, true);
 	field->animation.fall_levels++;
-	field->animation.falling = Tween(game, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, FALLING_TIME * (1.0 + field->animation.level_no * 0.025));
-	field->animation.hiding = Tween(game, 1.0, 0.0, TWEEN_STYLE_LINEAR, 0.25);
+	StartFieldTween(game, data, field, &field->animation.falling, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, FALLING_TIME * (1.0 + field->animation.level_no * 0.025));
+	StartFieldTween(game, data, field, &field->animation.hiding, 1.0, 0.0, TWEEN_STYLE_LINEAR, 0.25);
 }
 
 void Gravity(struct Game* game, struct GamestateResources* data) {
 	bool repeat;
 	do {
 		repeat = false;
-		for (int i = 0; i < COLS; i++) {
-			for (int j = ROWS - 1; j >= 0; j--) {
+		for (int i = 0; i < data->cols; i++) {
+			for (int j = data->rows - 1; j >= 0; j--) {
 				struct FieldID id = (struct FieldID){i, j};
 				struct Field* field = GetField(game, data, id);
 				if (field->type != FIELD_TYPE_EMPTY) {
@@ -347,8 +212,7 @@ void Gravity(struct Game* game, struct GamestateResources* data) {
 					} else {
 						upfield->animation.level_no = field->animation.level_no++;
 						upfield->animation.fall_levels++;
-						upfield->animation.falling = Tween(game, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, FALLING_TIME * (1.0 + upfield->animation.level_no * 0.025));
-						upfield->animation.falling.predelay = upfield->animation.level_no * 0.01;
+						StartFieldTween(game, data, upfield, &upfield->animation.falling, 0.0, 1.0, TWEEN_STYLE_BOUNCE_OUT, FALLING_TIME * (1.0 + upfield->animation.level_no * 0.025))->predelay = upfield->animation.level_no * 0.01;
 						Swap(game, data, id, up);
 					}
 				} else {
@@ -358,17 +222,17 @@ void Gravity(struct Game* game, struct GamestateResources* data) {
 		}
 	} while (repeat);
 
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			data->fields[i][j].locked = false;
 		}
 	}
 }
 
 static void HandleDeadlock(struct Game* game, struct GamestateResources* data) {
-	// TODO: randomly swapping all animals around is probably a better idea?
-	int J = ROWS / 2;
-	for (int i = 0; i < COLS; i++) {
+	// last resort when ShuffleAnimals couldn't find anything playable
+	int J = data->rows / 2;
+	for (int i = 0; i < data->cols; i++) {
 		for (int j = -1; j <= 1; j++) {
 			if (data->fields[i][J + j].type == FIELD_TYPE_ANIMAL) {
 				data->fields[i][J + j].to_remove = true;
@@ -377,40 +241,53 @@ static void HandleDeadlock(struct Game* game, struct GamestateResources* data) {
 	}
 }
 
-void ProcessFields(struct Game* game, struct GamestateResources* data) {
+static bool ResolveFields(struct Game* game, struct GamestateResources* data) {
+	// returns whether there are fields to remove, otherwise the board has settled
 	bool matched = MarkMatching(game, data);
 	bool collected = Collect(game, data);
 	if (matched || collected) {
 		while (AnimateSpecials(game, data)) {
 			Collect(game, data);
 		}
+		return true;
+	}
+
+	// deadlock handling
+	int moves = CountMoves(game, data);
+	PrintConsole(game, "possible moves: %d", moves);
+	if (moves == 0 && !ShuffleAnimals(game, data)) {
+		HandleDeadlock(game, data);
+		return true;
+	}
+	return false;
+}
+
+void ProcessFields(struct Game* game, struct GamestateResources* data) {
+	if (ResolveFields(game, data)) {
 		TM_AddAction(data->timeline, DispatchAnimations, NULL);
-	} else {
-		// deadlock handling
-		int moves = CountMoves(game, data);
-		PrintConsole(game, "possible moves: %d", moves);
-		if (moves == 0) {
-			HandleDeadlock(game, data);
-			TM_AddAction(data->timeline, DispatchAnimations, NULL);
-		} else {
-			data->locked = false;
-			if (!data->goal_lock) {
-				if (CheckGoals(game, data)) {
-					FinishLevel(game, data);
-				} else if (!data->infinite && data->moves == data->moves_goal) {
-					FailLevel(game, data);
-				}
-			}
-			data->goal_lock = false;
+		return;
+	}
+
+	data->turn.running = false;
+	data->locked = false;
+	if (!data->goal_lock) {
+		if (CheckGoals(game, data)) {
+			FinishLevel(game, data);
+		} else if (!data->infinite && data->moves == data->moves_goal) {
+			FailLevel(game, data);
 		}
 	}
+	data->goal_lock = false;
 }
 
 int CountMoves(struct Game* game, struct GamestateResources* data) {
+	if (data->moves_cache.valid && data->moves_cache.hash == data->hash) {
+		return data->moves_cache.moves;
+	}
 	int moves = 0;
-	bool marked[COLS][ROWS] = {};
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	bool marked[MAX_COLS][MAX_ROWS] = {};
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			struct FieldID id = {.i = i, .j = j};
 			if (CanBeMatched(game, data, id)) {
 				if (!marked[i][j]) {
@@ -420,15 +297,17 @@ int CountMoves(struct Game* game, struct GamestateResources* data) {
 			}
 		}
 	}
+	data->moves_cache.hash = data->hash;
+	data->moves_cache.moves = moves;
+	data->moves_cache.valid = true;
 	return moves;
 }
 
 static void AnimateRemoval(struct Game* game, struct GamestateResources* data) {
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			if (data->fields[i][j].to_remove) {
-				data->fields[i][j].animation.hiding = Tween(game, 0.0, 1.0, TWEEN_STYLE_LINEAR, MATCHING_TIME);
-				data->fields[i][j].animation.hiding.predelay = MATCHING_DELAY_TIME;
+				StartFieldTween(game, data, &data->fields[i][j], &data->fields[i][j].animation.hiding, 0.0, 1.0, TWEEN_STYLE_LINEAR, MATCHING_TIME)->predelay = MATCHING_DELAY_TIME;
 				if (data->fields[i][j].type == FIELD_TYPE_FREEFALL) {
 					data->nests[i].tween = Tween(game, 0.0, 1.0, TWEEN_STYLE_SINE_OUT, SHAKING_TIME);
 					data->nests[i].tween.predelay = 0.5;
@@ -439,11 +318,11 @@ static void AnimateRemoval(struct Game* game, struct GamestateResources* data) {
 }
 
 static void PerformActions(struct Game* game, struct GamestateResources* data) {
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			if (data->fields[i][j].matched) {
 				if (data->fields[i][j].type == FIELD_TYPE_ANIMAL) {
-					SelectSpritesheet(game, data->fields[i][j].drawable, ANIMAL_ACTIONS[data->fields[i][j].data.animal.type].names[rand() % ANIMAL_ACTIONS[data->fields[i][j].type].actions]);
+					SelectRandomAnimalAction(game, data, &data->fields[i][j]);
 
 					if (data->fields[i][j].matched >= 4 && data->fields[i][j].match_mark) {
 						TurnMatchToSuper(game, data, data->fields[i][j].matched, data->fields[i][j].match_mark);
@@ -460,8 +339,8 @@ static void PerformActions(struct Game* game, struct GamestateResources* data) {
 }
 
 void DoRemoval(struct Game* game, struct GamestateResources* data) {
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			data->fields[i][j].animation.fall_levels = 0;
 			data->fields[i][j].animation.level_no = 0;
 			data->fields[i][j].animation.super = (struct FieldID){-1, -1};
@@ -489,6 +368,7 @@ void DoRemoval(struct Game* game, struct GamestateResources* data) {
 				}
 
 				data->fields[i][j].type = FIELD_TYPE_EMPTY;
+				UpdateFieldHash(game, data, &data->fields[i][j]);
 				data->fields[i][j].to_remove = false;
 				data->fields[i][j].animation.hiding = StaticTween(game, 0.0);
 				data->fields[i][j].animation.falling = StaticTween(game, 1.0);
@@ -502,8 +382,8 @@ void DoRemoval(struct Game* game, struct GamestateResources* data) {
 }
 
 void StopAnimations(struct Game* game, struct GamestateResources* data) {
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			data->fields[i][j].animation.fall_levels = 0;
 			data->fields[i][j].animation.level_no = 0;
 			data->fields[i][j].animation.hiding = StaticTween(game, 0.0);
@@ -517,6 +397,36 @@ void StopAnimations(struct Game* game, struct GamestateResources* data) {
 	}
 }
 
+static bool IsFieldAnimating(struct Field* field) {
+	struct Tween* tweens[] = {&field->animation.falling, &field->animation.hiding, &field->animation.swapping, &field->animation.shaking,
+		&field->animation.hinting, &field->animation.launching, &field->animation.collecting};
+	for (size_t i = 0; i < sizeof(tweens) / sizeof(tweens[0]); i++) {
+		if (GetTweenPosition(tweens[i]) < 1.0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void UpdateFieldAnimations(struct Game* game, struct GamestateResources* data, double delta) {
+	for (int n = 0; n < data->animating.count; n++) {
+		struct FieldID id = data->animating.ids[n];
+		struct Field* field = GetField(game, data, id);
+		UpdateTween(&field->animation.falling, delta);
+		UpdateTween(&field->animation.hiding, delta);
+		UpdateTween(&field->animation.swapping, delta);
+		UpdateTween(&field->animation.shaking, delta);
+		UpdateTween(&field->animation.hinting, delta);
+		UpdateTween(&field->animation.launching, delta);
+		UpdateTween(&field->animation.collecting, delta);
+
+		if (!IsFieldAnimating(field)) {
+			data->animating.listed[id.i][id.j] = false;
+			data->animating.ids[n--] = data->animating.ids[--data->animating.count];
+		}
+	}
+}
+
 void Swap(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two) {
 	struct Field tmp = data->fields[one.i][one.j];
 	data->fields[one.i][one.j] = data->fields[two.i][two.j];
@@ -526,6 +436,14 @@ void Swap(struct Game* game, struct GamestateResources* data, struct FieldID one
 	float highlight = data->fields[one.i][one.j].highlight;
 	data->fields[one.i][one.j].highlight = data->fields[two.i][two.j].highlight;
 	data->fields[two.i][two.j].highlight = highlight;
+	UpdateFieldHash(game, data, &data->fields[one.i][one.j]);
+	UpdateFieldHash(game, data, &data->fields[two.i][two.j]);
+	SwapIdleAnimations(data, one, two);
+	if (data->animating.listed[one.i][one.j] || data->animating.listed[two.i][two.j]) {
+		// running tweens move along with the fields
+		AnimateField(game, data, one);
+		AnimateField(game, data, two);
+	}
 }
 
 static TM_ACTION(TriggerProcessing) {
@@ -541,9 +459,9 @@ static TM_ACTION(AnimateSwapping) {
 			struct Field* two = TM_GetArg(action->arguments, 1);
 			double* timeout = TM_GetArg(action->arguments, 2);
 			data->locked = true;
-			one->animation.swapping = Tween(game, 0.0, 1.0, TWEEN_STYLE_SINE_IN_OUT, *timeout);
+			StartFieldTween(game, data, one, &one->animation.swapping, 0.0, 1.0, TWEEN_STYLE_SINE_IN_OUT, *timeout);
 			one->animation.swapee = two->id;
-			two->animation.swapping = Tween(game, 0.0, 1.0, TWEEN_STYLE_SINE_IN_OUT, *timeout);
+			StartFieldTween(game, data, two, &two->animation.swapping, 0.0, 1.0, TWEEN_STYLE_SINE_IN_OUT, *timeout);
 			two->animation.swapee = one->id;
 			return TM_REPEAT;
 		}
@@ -577,12 +495,16 @@ void StartSwapping(struct Game* game, struct GamestateResources* data, struct Fi
 	data->swap1 = one;
 	data->swap2 = two;
 
+	PredictTurn(game, data, one, two, false);
+
 	TM_WrapArg(double, duration, SWAPPING_TIME);
 	TM_AddAction(data->timeline, AnimateSwapping, TM_Args(GetField(game, data, one), GetField(game, data, two), duration));
 	TM_AddAction(data->timeline, TriggerProcessing, NULL);
 }
 
 void StartBadSwapping(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two) {
+	PredictTurn(game, data, one, two, true);
+
 	{
 		TM_WrapArg(double, duration, SWAPPING_TIME);
 		TM_AddAction(data->timeline, AnimateSwapping, TM_Args(GetField(game, data, one), GetField(game, data, two), duration));
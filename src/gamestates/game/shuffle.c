@@ -0,0 +1,174 @@
+/*! \file shuffle.c
+ *  \brief Shuffling the animals around to get out of a deadlock.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * Awake animals get redistributed over the cells they already occupy. Cells
+ * are filled in row-major order and each one only picks from the animals
+ * that don't complete a line with the two cells to the left or above it,
+ * so the result never contains a match. The layout is then checked for
+ * an available move; if there's none, we try again with a different seed.
+ *
+ * Match checks are done on bitboards, with one bit mask per row of the board
+ * for each animal type.
+ */
+
+#define SHUFFLE_ATTEMPTS 64
+#define SHUFFLE_TIME 0.5
+
+#define BIT(i) (1u << (i))
+
+struct ShuffledAnimal {
+	enum ANIMAL_TYPE type;
+	bool super;
+};
+
+struct Bitboards {
+	int cols, rows;
+	uint16_t animals[ANIMAL_TYPES][MAX_ROWS];
+	uint16_t swappable[MAX_ROWS];
+};
+
+static bool HasMatch(struct Bitboards* boards) {
+	for (int t = 0; t < ANIMAL_TYPES; t++) {
+		uint16_t* b = boards->animals[t];
+		for (int j = 0; j < boards->rows; j++) {
+			if (b[j] & (b[j] >> 1) & (b[j] >> 2)) {
+				return true;
+			}
+			if (j + 2 < boards->rows && (b[j] & b[j + 1] & b[j + 2])) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static void SwapBits(struct Bitboards* boards, int i1, int j1, int i2, int j2) {
+	for (int t = 0; t < ANIMAL_TYPES; t++) {
+		uint16_t* b = boards->animals[t];
+		if (!(b[j1] & BIT(i1)) != !(b[j2] & BIT(i2))) {
+			b[j1] ^= BIT(i1);
+			b[j2] ^= BIT(i2);
+		}
+	}
+}
+
+static bool HasMove(struct Bitboards* boards) {
+	for (int i = 0; i < boards->cols; i++) {
+		for (int j = 0; j < boards->rows; j++) {
+			if (!(boards->swappable[j] & BIT(i))) {
+				continue;
+			}
+			int neighbours[2][2] = {{i + 1, j}, {i, j + 1}};
+			for (int q = 0; q < 2; q++) {
+				int ni = neighbours[q][0], nj = neighbours[q][1];
+				if (ni >= boards->cols || nj >= boards->rows || !(boards->swappable[nj] & BIT(ni))) {
+					continue;
+				}
+				SwapBits(boards, i, j, ni, nj);
+				bool match = HasMatch(boards);
+				SwapBits(boards, i, j, ni, nj);
+				if (match) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+static bool CompletesLine(struct Bitboards* boards, int type, int i, int j) {
+	uint16_t* b = boards->animals[type];
+	if (i >= 2 && (b[j] & BIT(i - 1)) && (b[j] & BIT(i - 2))) {
+		return true;
+	}
+	if (j >= 2 && (b[j - 1] & BIT(i)) && (b[j - 2] & BIT(i))) {
+		return true;
+	}
+	return false;
+}
+
+bool ShuffleAnimals(struct Game* game, struct GamestateResources* data) {
+	double start = al_get_time();
+
+	struct Field* cells[MAX_COLS * MAX_ROWS];
+	struct ShuffledAnimal pool[MAX_COLS * MAX_ROWS], assigned[MAX_COLS * MAX_ROWS];
+	int count = 0;
+
+	struct Bitboards fixed = {.cols = data->cols, .rows = data->rows};
+	for (int j = 0; j < data->rows; j++) {
+		for (int i = 0; i < data->cols; i++) {
+			struct Field* field = &data->fields[i][j];
+			if (field->type == FIELD_TYPE_ANIMAL && !field->data.animal.sleeping) {
+				cells[count] = field;
+				pool[count] = (struct ShuffledAnimal){field->data.animal.type, field->data.animal.super};
+				count++;
+				fixed.swappable[j] |= BIT(i);
+			} else if (field->type == FIELD_TYPE_COLLECTIBLE) {
+				fixed.swappable[j] |= BIT(i);
+			}
+		}
+	}
+
+	for (int attempt = 1; attempt <= SHUFFLE_ATTEMPTS; attempt++) {
+		struct Bitboards boards = fixed;
+		int left = count;
+		bool ok = true;
+		for (int c = 0; c < count && ok; c++) {
+			int i = cells[c]->id.i, j = cells[c]->id.j;
+			int candidates[MAX_COLS * MAX_ROWS], n = 0;
+			for (int p = 0; p < left; p++) {
+				if (!CompletesLine(&boards, pool[p].type, i, j)) {
+					candidates[n++] = p;
+				}
+			}
+			if (!n) {
+				ok = false;
+				break;
+			}
+			int p = candidates[RollRandom(data) % n];
+			assigned[c] = pool[p];
+			boards.animals[pool[p].type][j] |= BIT(i);
+			// move it past the end of the pool, so the pool stays complete for the next attempt
+			left--;
+			pool[p] = pool[left];
+			pool[left] = assigned[c];
+		}
+		if (!ok || !HasMove(&boards)) {
+			continue;
+		}
+
+		for (int c = 0; c < count; c++) {
+			struct Field* field = cells[c];
+			field->data.animal.type = assigned[c].type;
+			field->data.animal.super = assigned[c].super;
+			StartFieldTween(game, data, field, &field->animation.hiding, 1.0, 0.0, TWEEN_STYLE_SINE_OUT, SHUFFLE_TIME);
+			UpdateDrawable(game, data, field->id);
+			UpdateFieldHash(game, data, field);
+		}
+		PrintConsole(game, "Deadlock resolved by shuffling after %d attempt(s) in %.3f ms.", attempt, (al_get_time() - start) * 1000.0);
+		return true;
+	}
+
+	PrintConsole(game, "Failed to find a playable shuffle in %d attempts (%.3f ms).", SHUFFLE_ATTEMPTS, (al_get_time() - start) * 1000.0);
+	return false;
+}
@@ -0,0 +1,553 @@
+/*! \file simulation.c
+ *  \brief Lightweight board simulation used to evaluate possible moves.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * The simulation mirrors what ProcessFields, AfterMatching and friends do
+ * during a turn (see logic.c), but works on a plain copy of the board without
+ * any tweens, drawables or timeline actions, so whole cascades can be played
+ * out in a few microseconds without allocating anything.
+ *
+ * Fields that get generated during a cascade are unknown to us. By default
+ * they're left as "unknown" fields that never match; when sampling refills
+ * (for the expectimax search) they're rolled according to level settings,
+ * with a generator seeded from the board, so that searches are reproducible.
+ *
+ * The search is bounded by the number of simulated moves rather than by time,
+ * so its outcome doesn't depend on how fast the machine is or how loaded it
+ * happens to be. The time budget is only there as a safety cap.
+ */
+
+#define SIMULATION_MAX_CASCADES 32
+#define SIMULATION_REFILL_SAMPLES 4
+#define SIMULATION_GOAL_WEIGHT 100.0
+#define SIMULATION_DISCOUNT 0.9
+
+static inline bool SimIsValid(struct SimBoard* board, int i, int j) {
+	return i >= 0 && j >= 0 && i < board->cols && j < board->rows;
+}
+
+static inline bool SimIsMatchable(struct SimField* field) {
+	return field->type == FIELD_TYPE_ANIMAL && !field->sleeping && !field->unknown;
+}
+
+static inline bool SimIsSwappable(struct SimField* field) {
+	return (SimIsMatchable(field)) || (field->type == FIELD_TYPE_COLLECTIBLE);
+}
+
+void TakeSnapshot(struct Game* game, struct GamestateResources* data, struct SimBoard* board) {
+	board->cols = data->cols;
+	board->rows = data->rows;
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			struct Field* field = &data->fields[i][j];
+			struct SimField* sim = &board->fields[i][j];
+			*sim = (struct SimField){.type = field->type};
+			if (field->type == FIELD_TYPE_ANIMAL) {
+				sim->subtype = field->data.animal.type;
+				sim->sleeping = field->data.animal.sleeping;
+				sim->super = field->data.animal.super;
+			} else if (field->type == FIELD_TYPE_COLLECTIBLE) {
+				sim->subtype = field->data.collectible.type;
+				sim->variant = field->data.collectible.variant;
+			}
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		board->goals[i] = data->goals[i];
+	}
+	board->score = 0;
+	board->supers = data->level.supers;
+	// sampled refills depend only on the board, so the same board always gets the same hint
+	board->random = data->hash;
+}
+
+void TakeLevelSnapshot(struct Game* game, struct GamestateResources* data, struct SimBoard* board) {
+	board->cols = data->level.cols;
+	board->rows = data->level.rows;
+	// fields that the level leaves up to chance are unknown
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			struct SimField* sim = &board->fields[i][j];
+			*sim = (struct SimField){.type = data->level.fields[i][j].field_type};
+			switch (sim->type) {
+				case FIELD_TYPE_ANIMAL:
+					sim->subtype = data->level.fields[i][j].animal_type;
+					sim->unknown = data->level.fields[i][j].random_subtype;
+					sim->sleeping = data->level.fields[i][j].sleeping;
+					sim->super = data->level.fields[i][j].super;
+					break;
+				case FIELD_TYPE_COLLECTIBLE:
+					sim->subtype = data->level.fields[i][j].collectible_type;
+					sim->variant = data->level.fields[i][j].variant;
+					break;
+				case FIELD_TYPE_EMPTY:
+					sim->type = FIELD_TYPE_ANIMAL;
+					sim->unknown = true;
+					break;
+				default:
+					break;
+			}
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		board->goals[i] = data->level.goals[i];
+	}
+	board->score = 0;
+	board->supers = data->level.supers;
+	board->random = data->level.id;
+}
+
+bool AreSimGoalsReached(struct SimBoard* board) {
+	for (int i = 0; i < 3; i++) {
+		if (board->goals[i].type != GOAL_TYPE_NONE && board->goals[i].value > 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void SimUpdateGoal(struct SimBoard* board, enum GOAL_TYPE type, int val) {
+	for (int i = 0; i < 3; i++) {
+		if (board->goals[i].type == type) {
+			board->goals[i].value -= val;
+		}
+	}
+}
+
+static void SimAddScore(struct SimBoard* board, int val) {
+	board->score += val;
+	SimUpdateGoal(board, GOAL_TYPE_SCORE, val);
+}
+
+static int SimIsMatching(struct SimBoard* board, int i, int j) {
+	if (!SimIsValid(board, i, j)) {
+		return 0;
+	}
+	struct SimField* orig = &board->fields[i][j];
+	if (!SimIsMatchable(orig)) {
+		return 0;
+	}
+
+	static const int di[] = {-1, 1, 0, 0}, dj[] = {0, 0, -1, 1};
+	int lchain = 0, tchain = 0;
+	struct SimField *lfields[MAX_COLS], *tfields[MAX_ROWS];
+	int* accumulators[] = {&lchain, &lchain, &tchain, &tchain};
+	struct SimField** lists[] = {lfields, lfields, tfields, tfields};
+
+	for (int q = 0; q < 4; q++) {
+		int x = i + di[q], y = j + dj[q];
+		while (SimIsValid(board, x, y)) {
+			struct SimField* field = &board->fields[x][y];
+			if (!SimIsMatchable(field) || field->subtype != orig->subtype) {
+				break;
+			}
+			lists[q][*accumulators[q]] = field;
+			(*accumulators[q])++;
+			x += di[q];
+			y += dj[q];
+		}
+	}
+
+	int chain = 0;
+	if (lchain >= 2) {
+		chain += lchain;
+	}
+	if (tchain >= 2) {
+		chain += tchain;
+	}
+	if (chain) {
+		chain++;
+		if (!orig->match_mark) {
+			orig->match_mark = j * MAX_COLS + i;
+		}
+		for (int q = 0; q < lchain && lchain >= 2; q++) {
+			if (lfields[q]->match_mark < orig->match_mark) {
+				lfields[q]->match_mark = orig->match_mark;
+			}
+		}
+		for (int q = 0; q < tchain && tchain >= 2; q++) {
+			if (tfields[q]->match_mark < orig->match_mark) {
+				tfields[q]->match_mark = orig->match_mark;
+			}
+		}
+	}
+	return chain;
+}
+
+static void SimSwap(struct SimBoard* board, struct FieldID one, struct FieldID two) {
+	struct SimField tmp = board->fields[one.i][one.j];
+	board->fields[one.i][one.j] = board->fields[two.i][two.j];
+	board->fields[two.i][two.j] = tmp;
+}
+
+static bool SimIsLegalMove(struct SimBoard* board, struct FieldID one, struct FieldID two) {
+	if (!SimIsSwappable(&board->fields[one.i][one.j]) || !SimIsSwappable(&board->fields[two.i][two.j])) {
+		return false;
+	}
+	SimSwap(board, one, two);
+	bool result = SimIsMatching(board, one.i, one.j) || SimIsMatching(board, two.i, two.j);
+	SimSwap(board, one, two);
+	// SimIsMatching only marks fields in line with the one it checks, so only the rows
+	// and columns of the swapped pair need to be cleaned up
+	struct FieldID pair[] = {one, two};
+	for (int q = 0; q < 2; q++) {
+		for (int i = 0; i < board->cols; i++) {
+			board->fields[i][pair[q].j].match_mark = 0;
+		}
+		for (int j = 0; j < board->rows; j++) {
+			board->fields[pair[q].i][j].match_mark = 0;
+		}
+	}
+	return result;
+}
+
+static int SimMarkMatching(struct SimBoard* board) {
+	int matching = 0;
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			board->fields[i][j].matched = SimIsMatching(board, i, j);
+			if (board->fields[i][j].matched) {
+				board->fields[i][j].to_remove = true;
+				matching++;
+			}
+		}
+	}
+	return matching;
+}
+
+static bool SimShouldBeCollected(struct SimBoard* board, int i, int j) {
+	if (board->fields[i][j].handled) {
+		return false;
+	}
+	return SimIsMatching(board, i, j - 1) || SimIsMatching(board, i, j + 1) || SimIsMatching(board, i - 1, j) || SimIsMatching(board, i + 1, j);
+}
+
+static int SimCollect(struct SimBoard* board) {
+	int collected = 0;
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			struct SimField* field = &board->fields[i][j];
+			if (field->type == FIELD_TYPE_FREEFALL) {
+				bool to_collect = true;
+				for (int a = j + 1; a < board->rows; a++) {
+					if (board->fields[i][a].type != FIELD_TYPE_DISABLED) {
+						to_collect = false;
+						break;
+					}
+				}
+				if (to_collect) {
+					field->to_remove = true;
+					field->handled = true;
+					SimAddScore(board, 100);
+					collected++;
+				}
+			} else if (SimShouldBeCollected(board, i, j) || field->to_remove) {
+				if (field->type == FIELD_TYPE_ANIMAL && field->sleeping) {
+					field->sleeping = false;
+					field->to_remove = false;
+					field->handled = true;
+					collected++;
+					SimAddScore(board, 10);
+					SimUpdateGoal(board, GOAL_TYPE_SLEEPING, 1);
+				} else if (field->type == FIELD_TYPE_COLLECTIBLE) {
+					field->variant++;
+					if (field->variant >= SPECIAL_ACTIONS[FIRST_COLLECTIBLE + field->subtype].actions) {
+						field->variant = SPECIAL_ACTIONS[FIRST_COLLECTIBLE + field->subtype].actions - 1;
+						field->to_remove = true;
+						SimAddScore(board, 50);
+					} else {
+						field->to_remove = false;
+						SimAddScore(board, 20);
+					}
+					field->handled = true;
+					collected++;
+				}
+			}
+		}
+	}
+	return collected;
+}
+
+static void SimHandleSpecialed(struct SimBoard* board, int i, int j) {
+	struct SimField* field = &board->fields[i][j];
+	SimAddScore(board, 10);
+	if (field->type != FIELD_TYPE_FREEFALL && field->type != FIELD_TYPE_DISABLED) {
+		field->to_remove = true;
+	}
+}
+
+static bool SimLaunchSpecials(struct SimBoard* board) {
+	bool found = false;
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			struct SimField* field = &board->fields[i][j];
+			if (field->to_remove && !field->handled && field->type == FIELD_TYPE_ANIMAL && field->super) {
+				field->handled = true;
+				for (int x = 0; x < board->cols; x++) {
+					if (x != i) {
+						SimHandleSpecialed(board, x, j);
+					}
+				}
+				for (int y = 0; y < board->rows; y++) {
+					if (y != j) {
+						SimHandleSpecialed(board, i, y);
+					}
+				}
+				SimAddScore(board, 210);
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+static void SimTurnMatchToSuper(struct SimBoard* board, int mark, struct FieldID one, struct FieldID two) {
+	struct SimField* super = NULL;
+	if (board->fields[one.i][one.j].matched && board->fields[one.i][one.j].match_mark == mark) {
+		super = &board->fields[one.i][one.j];
+	} else if (board->fields[two.i][two.j].matched && board->fields[two.i][two.j].match_mark == mark) {
+		super = &board->fields[two.i][two.j];
+	}
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			if (board->fields[i][j].match_mark == mark) {
+				if (!super) {
+					// the game picks a random one, but it doesn't matter much for the evaluation
+					super = &board->fields[i][j];
+				}
+				board->fields[i][j].match_mark = 0;
+			}
+		}
+	}
+	if (board->supers && super) {
+		super->super = true;
+		super->to_remove = false;
+		SimAddScore(board, 50);
+	}
+}
+
+static void SimPerformActions(struct SimBoard* board, struct FieldID one, struct FieldID two) {
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			struct SimField* field = &board->fields[i][j];
+			if (field->matched) {
+				if (field->type == FIELD_TYPE_ANIMAL && field->matched >= 4 && field->match_mark) {
+					SimTurnMatchToSuper(board, field->match_mark, one, two);
+				}
+				SimAddScore(board, 10);
+			}
+		}
+	}
+}
+
+static void SimDoRemoval(struct SimBoard* board) {
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			struct SimField* field = &board->fields[i][j];
+			field->handled = false;
+			field->matched = 0;
+			field->match_mark = 0;
+			if (!field->to_remove) {
+				continue;
+			}
+			if (field->type == FIELD_TYPE_ANIMAL) {
+				SimUpdateGoal(board, GOAL_TYPE_ANIMAL, 1);
+				if (!field->unknown) {
+					SimUpdateGoal(board, GOAL_TYPE_ANIMAL + 1 + field->subtype, 1);
+				}
+				if (field->sleeping) {
+					SimUpdateGoal(board, GOAL_TYPE_SLEEPING, 1);
+				}
+				if (field->super) {
+					SimUpdateGoal(board, GOAL_TYPE_SUPER, 1);
+				}
+			}
+			if (field->type == FIELD_TYPE_COLLECTIBLE) {
+				SimUpdateGoal(board, GOAL_TYPE_COLLECTIBLE, 1);
+				SimUpdateGoal(board, GOAL_TYPE_COLLECTIBLE + 1 + field->subtype, 1);
+			}
+			if (field->type == FIELD_TYPE_FREEFALL) {
+				SimUpdateGoal(board, GOAL_TYPE_FREEFALL, 1);
+			}
+			*field = (struct SimField){.type = FIELD_TYPE_EMPTY};
+		}
+	}
+}
+
+static void SimGenerateField(struct GamestateResources* data, struct SimBoard* board, struct SimField* field, bool sample) {
+	*field = (struct SimField){.type = FIELD_TYPE_ANIMAL, .unknown = !sample};
+	if (sample && data->level.field_types[FIELD_TYPE_ANIMAL]) {
+		do {
+			field->subtype = RollRandomState(&board->random) % ANIMAL_TYPES;
+		} while (!data->level.animals[field->subtype]);
+	}
+}
+
+static void SimGravity(struct GamestateResources* data, struct SimBoard* board, bool sample) {
+	bool repeat;
+	do {
+		repeat = false;
+		for (int i = 0; i < board->cols; i++) {
+			for (int j = board->rows - 1; j >= 0; j--) {
+				if (board->fields[i][j].type != FIELD_TYPE_EMPTY) {
+					continue;
+				}
+				int up = j - 1;
+				while (up >= 0 && board->fields[i][up].type == FIELD_TYPE_DISABLED) {
+					up--;
+				}
+				if (up >= 0) {
+					if (board->fields[i][up].type == FIELD_TYPE_EMPTY) {
+						repeat = true;
+					} else {
+						SimSwap(board, (struct FieldID){i, j}, (struct FieldID){i, up});
+					}
+				} else {
+					SimGenerateField(data, board, &board->fields[i][j], sample);
+				}
+			}
+		}
+	} while (repeat);
+}
+
+void SimulateMove(struct GamestateResources* data, struct SimBoard* board, struct FieldID one, struct FieldID two, bool sample) {
+	SimSwap(board, one, two);
+	for (int cascade = 0; cascade < SIMULATION_MAX_CASCADES; cascade++) {
+		int matched = SimMarkMatching(board);
+		int collected = SimCollect(board);
+		if (!matched && !collected) {
+			break;
+		}
+		while (SimLaunchSpecials(board)) {
+			SimCollect(board);
+		}
+		SimPerformActions(board, one, two);
+		SimDoRemoval(board);
+		SimGravity(data, board, sample);
+	}
+}
+
+static double SimValue(struct SimBoard* before, struct SimBoard* after) {
+	double value = after->score - before->score;
+	for (int i = 0; i < 3; i++) {
+		if (before->goals[i].type == GOAL_TYPE_NONE || before->goals[i].type == GOAL_TYPE_SCORE) {
+			continue;
+		}
+		int remaining = before->goals[i].value > 0 ? before->goals[i].value : 0;
+		int left = after->goals[i].value > 0 ? after->goals[i].value : 0;
+		value += (remaining - left) * SIMULATION_GOAL_WEIGHT;
+	}
+	return value;
+}
+
+int ListSimMoves(struct SimBoard* board, struct Move* moves) {
+	int count = 0;
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			struct FieldID one = {i, j};
+			struct FieldID neighbours[] = {{i + 1, j}, {i, j + 1}};
+			for (int q = 0; q < 2; q++) {
+				if (SimIsValid(board, neighbours[q].i, neighbours[q].j) && SimIsLegalMove(board, one, neighbours[q])) {
+					moves[count++] = (struct Move){.one = one, .two = neighbours[q]};
+				}
+			}
+		}
+	}
+	return count;
+}
+
+static double SimBestImmediateValue(struct GamestateResources* data, struct SimBoard* board, int* nodes) {
+	struct Move moves[MAX_MOVES];
+	int count = ListSimMoves(board, moves);
+	double best = 0.0;
+	for (int m = 0; m < count; m++) {
+		struct SimBoard copy = *board;
+		SimulateMove(data, &copy, moves[m].one, moves[m].two, false);
+		(*nodes)++;
+		double value = SimValue(board, &copy);
+		if (value > best) {
+			best = value;
+		}
+	}
+	return best;
+}
+
+static double SimExpectimax(struct GamestateResources* data, struct SimBoard* board, struct Move* move, int* nodes) {
+	double sum = 0.0;
+	for (int s = 0; s < SIMULATION_REFILL_SAMPLES; s++) {
+		struct SimBoard copy = *board;
+		copy.random += s;
+		SimulateMove(data, &copy, move->one, move->two, true);
+		(*nodes)++;
+		sum += SimValue(board, &copy) + SIMULATION_DISCOUNT * SimBestImmediateValue(data, &copy, nodes);
+	}
+	return sum / SIMULATION_REFILL_SAMPLES;
+}
+
+static int CompareMoves(const void* a, const void* b) {
+	const struct Move *one = a, *two = b;
+	return (one->value < two->value) - (one->value > two->value);
+}
+
+bool FindBestMove(struct Game* game, struct GamestateResources* data, int depth, int nodes, double budget, struct Move* move) {
+	double deadline = al_get_time() + budget;
+	struct SimBoard board;
+	TakeSnapshot(game, data, &board);
+
+	struct Move moves[MAX_MOVES];
+	int count = ListSimMoves(&board, moves);
+	if (!count) {
+		return false;
+	}
+
+	// the first move always gets evaluated, so there's something to return
+	int evaluated = 0, used = 0;
+	for (int m = 0; m < count && (!m || (used < nodes && al_get_time() < deadline)); m++) {
+		struct SimBoard copy = board;
+		SimulateMove(data, &copy, moves[m].one, moves[m].two, false);
+		moves[m].value = SimValue(&board, &copy);
+		evaluated++;
+		used++;
+	}
+	qsort(moves, evaluated, sizeof(struct Move), CompareMoves);
+	*move = moves[0];
+
+	if (depth >= 2) {
+		// refine the most promising moves first, as long as the budget lasts
+		int refined = 0;
+		for (int m = 0; m < evaluated && used < nodes && al_get_time() < deadline; m++) {
+			moves[m].value = SimExpectimax(data, &board, &moves[m], &used);
+			refined++;
+		}
+		qsort(moves, refined, sizeof(struct Move), CompareMoves);
+		*move = moves[0];
+	}
+
+	// make sure the first field is the one that ends up matched after moving
+	SimSwap(&board, move->one, move->two);
+	if (!SimIsMatching(&board, move->two.i, move->two.j)) {
+		struct FieldID tmp = move->one;
+		move->one = move->two;
+		move->two = tmp;
+	}
+	return true;
+}
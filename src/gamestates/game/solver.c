@@ -0,0 +1,294 @@
+/*! \file solver.c
+ *  \brief Verifier checking whether a level can be won without lucky refills.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * Starting from the level's initial layout, all swap sequences are searched
+ * with iterative deepening up to the level's move limit. Every field that
+ * would come from a refill (or is randomized by the level) stays unknown and
+ * never matches, so a found line wins no matter what gets spawned.
+ *
+ * Each iteration spreads the moves available at the root across worker
+ * threads. Every worker keeps its own transposition table of positions
+ * (board and goals, keyed by Zobrist hash) that were already proven to be
+ * lost with the given number of moves left, which stays valid between
+ * iterations.
+ *
+ * The iterations themselves run on a thread of their own, so the game keeps
+ * going while a level is being verified. It only works on the snapshot taken
+ * in VerifyLevel; the result is picked up by PollLevelVerification.
+ */
+
+#define SOLVER_MAX_WORKERS 8
+#define SOLVER_TABLE_SIZE (1 << 16)
+#define SOLVER_TIME_LIMIT 10.0
+
+struct SolverEntry {
+	uint64_t hash;
+	int remaining;
+};
+
+struct SolverWorker {
+	struct Solver* solver;
+	struct SolverEntry* table;
+	struct Move line[SOLVER_MAX_DEPTH];
+	long nodes;
+	bool stop;
+};
+
+struct Solver {
+	struct GamestateResources* data; // only passed along, nothing in it is read without sampling
+	struct SimBoard root;
+	struct Move moves[MAX_MOVES];
+	int count, next, depth, max_depth, workers;
+	int level, root_moves; // the level's ID and the moves it allows
+	double start, deadline;
+	bool solved, aborted, done;
+	struct Move line[SOLVER_MAX_DEPTH];
+	struct SolverWorker worker[SOLVER_MAX_WORKERS];
+	ALLEGRO_MUTEX* mutex;
+	ALLEGRO_THREAD* thread;
+};
+
+static bool ShouldStop(struct SolverWorker* worker) {
+	if (worker->stop) {
+		return true;
+	}
+	if (worker->nodes % 1024 == 0) {
+		struct Solver* solver = worker->solver;
+		al_lock_mutex(solver->mutex);
+		if (!solver->aborted && al_get_time() > solver->deadline) {
+			solver->aborted = true;
+		}
+		worker->stop = solver->solved || solver->aborted;
+		al_unlock_mutex(solver->mutex);
+	}
+	return worker->stop;
+}
+
+static bool Search(struct SolverWorker* worker, struct SimBoard* board, int ply, int remaining) {
+	if (AreSimGoalsReached(board)) {
+		return true;
+	}
+	if (!remaining) {
+		return false;
+	}
+	worker->nodes++;
+	if (ShouldStop(worker)) {
+		return false;
+	}
+
+	uint64_t hash = HashSimBoard(board);
+	struct SolverEntry* entry = &worker->table[hash % SOLVER_TABLE_SIZE];
+	if (entry->hash == hash && entry->remaining >= remaining) {
+		return false;
+	}
+
+	struct Move moves[MAX_MOVES];
+	int count = ListSimMoves(board, moves);
+	for (int m = 0; m < count; m++) {
+		struct SimBoard copy = *board;
+		SimulateMove(worker->solver->data, &copy, moves[m].one, moves[m].two, false);
+		worker->line[ply] = moves[m];
+		if (Search(worker, &copy, ply + 1, remaining - 1)) {
+			return true;
+		}
+	}
+
+	if (!worker->stop) {
+		entry->hash = hash;
+		entry->remaining = remaining;
+	}
+	return false;
+}
+
+static void* SolverThread(ALLEGRO_THREAD* thread, void* arg) {
+	struct SolverWorker* worker = arg;
+	struct Solver* solver = worker->solver;
+	worker->stop = false;
+	while (true) {
+		al_lock_mutex(solver->mutex);
+		int m = solver->next++;
+		bool done = m >= solver->count || solver->solved || solver->aborted;
+		al_unlock_mutex(solver->mutex);
+		if (done) {
+			break;
+		}
+
+		struct SimBoard copy = solver->root;
+		SimulateMove(solver->data, &copy, solver->moves[m].one, solver->moves[m].two, false);
+		worker->line[0] = solver->moves[m];
+		if (Search(worker, &copy, 1, solver->depth - 1)) {
+			al_lock_mutex(solver->mutex);
+			if (!solver->solved) {
+				solver->solved = true;
+				memcpy(solver->line, worker->line, sizeof(struct Move) * solver->depth);
+			}
+			al_unlock_mutex(solver->mutex);
+			break;
+		}
+	}
+	return NULL;
+}
+
+static void* VerifierThread(ALLEGRO_THREAD* thread, void* arg) {
+	struct Solver* solver = arg;
+	int depth = 0;
+	bool solved = false, aborted = false;
+	while (depth < solver->max_depth && !solved && !aborted) {
+		depth++;
+		al_lock_mutex(solver->mutex);
+		solver->depth = depth;
+		solver->next = 0;
+		al_unlock_mutex(solver->mutex);
+		ALLEGRO_THREAD* threads[SOLVER_MAX_WORKERS];
+		for (int w = 0; w < solver->workers; w++) {
+			threads[w] = al_create_thread(SolverThread, &solver->worker[w]);
+			al_start_thread(threads[w]);
+		}
+		for (int w = 0; w < solver->workers; w++) {
+			al_join_thread(threads[w], NULL);
+			al_destroy_thread(threads[w]);
+		}
+		al_lock_mutex(solver->mutex);
+		solved = solver->solved;
+		aborted = solver->aborted;
+		al_unlock_mutex(solver->mutex);
+	}
+	al_lock_mutex(solver->mutex);
+	solver->done = true;
+	al_unlock_mutex(solver->mutex);
+	return NULL;
+}
+
+static void FinishVerification(struct Game* game, struct GamestateResources* data, struct Solver* solver) {
+	struct SolverResult* result = &data->solver;
+	*result = (struct SolverResult){0};
+	for (int w = 0; w < solver->workers; w++) {
+		result->nodes += solver->worker[w].nodes;
+		free(solver->worker[w].table);
+	}
+	al_destroy_mutex(solver->mutex);
+
+	result->solved = solver->solved;
+	result->depth = solver->solved ? solver->depth : 0;
+	// the level allows more moves than the search can go deep, so running out of lines proves nothing
+	result->truncated = !solver->solved && !solver->aborted && solver->max_depth < solver->root_moves;
+	result->finished = solver->solved || (!solver->aborted && !result->truncated);
+	result->time = al_get_time() - solver->start;
+	memcpy(result->line, solver->line, sizeof(struct Move) * result->depth);
+
+	if (result->solved) {
+		PrintConsole(game, "Solver: level %d can be won in %d moves (%ld positions, %.2fs):", solver->level, result->depth, result->nodes, result->time);
+		for (int i = 0; i < result->depth; i++) {
+			PrintConsole(game, "  %d: %dx%d with %dx%d", i + 1, result->line[i].one.i, result->line[i].one.j, result->line[i].two.i, result->line[i].two.j);
+		}
+	} else if (result->finished) {
+		PrintConsole(game, "Solver: level %d can't be won without help from refills (%ld positions, %.2fs).", solver->level, result->nodes, result->time);
+	} else if (result->truncated) {
+		PrintConsole(game, "Solver: level %d can't be won in %d moves, the remaining %d weren't searched (%ld positions, %.2fs).", solver->level, solver->max_depth, solver->root_moves - solver->max_depth, result->nodes, result->time);
+	} else {
+		PrintConsole(game, "Solver: gave up on level %d at depth %d after %.2fs (%ld positions).", solver->level, solver->depth, result->time, result->nodes);
+	}
+	free(solver);
+}
+
+void VerifyLevel(struct Game* game, struct GamestateResources* data) {
+	if (data->verifier) {
+		return;
+	}
+	double start = al_get_time();
+	data->solver = (struct SolverResult){.finished = true};
+
+	if (data->level.infinite) {
+		PrintConsole(game, "Solver: infinite levels can't be won.");
+		data->solver.time = al_get_time() - start;
+		return;
+	}
+
+	struct Solver* solver = calloc(1, sizeof(struct Solver));
+	solver->data = data;
+	solver->level = data->level.id;
+	solver->start = start;
+	solver->deadline = start + SOLVER_TIME_LIMIT;
+	TakeLevelSnapshot(game, data, &solver->root);
+	if (AreSimGoalsReached(&solver->root)) {
+		free(solver);
+		data->solver.solved = true;
+		data->solver.time = al_get_time() - start;
+		PrintConsole(game, "Solver: the level has no goals to reach.");
+		return;
+	}
+	solver->count = ListSimMoves(&solver->root, solver->moves);
+	solver->root_moves = data->level.moves;
+	solver->max_depth = fmin(data->level.moves, SOLVER_MAX_DEPTH);
+	solver->mutex = al_create_mutex();
+
+	solver->workers = fmin(fmax(al_get_cpu_count(), 1), SOLVER_MAX_WORKERS);
+	for (int w = 0; w < solver->workers; w++) {
+		solver->worker[w] = (struct SolverWorker){.solver = solver, .table = calloc(SOLVER_TABLE_SIZE, sizeof(struct SolverEntry))};
+	}
+
+	data->verifier = solver;
+	solver->thread = al_create_thread(VerifierThread, solver);
+	if (solver->thread) {
+		al_start_thread(solver->thread);
+		PrintConsole(game, "Solver: verifying level %d...", solver->level);
+	} else {
+		VerifierThread(NULL, solver);
+		PollLevelVerification(game, data);
+	}
+}
+
+void PollLevelVerification(struct Game* game, struct GamestateResources* data) {
+	struct Solver* solver = data->verifier;
+	if (!solver) {
+		return;
+	}
+	al_lock_mutex(solver->mutex);
+	bool done = solver->done;
+	al_unlock_mutex(solver->mutex);
+	if (!done) {
+		return;
+	}
+	if (solver->thread) {
+		al_join_thread(solver->thread, NULL);
+		al_destroy_thread(solver->thread);
+	}
+	data->verifier = NULL;
+	FinishVerification(game, data, solver);
+}
+
+void StopLevelVerification(struct Game* game, struct GamestateResources* data) {
+	struct Solver* solver = data->verifier;
+	if (!solver) {
+		return;
+	}
+	al_lock_mutex(solver->mutex);
+	solver->aborted = true;
+	al_unlock_mutex(solver->mutex);
+	if (solver->thread) {
+		al_join_thread(solver->thread, NULL);
+		al_destroy_thread(solver->thread);
+	}
+	data->verifier = NULL;
+	FinishVerification(game, data, solver);
+}
@@ -28,6 +28,7 @@ static void TurnFieldToSuper(struct Game* game, struct GamestateResources* data,
 	field->data.animal.super = true;
 	field->to_remove = false;
 	UpdateDrawable(game, data, id);
+	UpdateFieldHash(game, data, field);
 	SpawnParticles(game, data, id, 64);
 	AddScore(game, data, 50);
 }
@@ -45,9 +46,9 @@ void TurnMatchToSuper(struct Game* game, struct GamestateResources* data, int ma
 	} else if (field2->matched && field2->match_mark == mark) {
 		super = field2->id;
 	} else {
-		int nr = rand() % matched;
-		for (int i = 0; i < COLS; i++) {
-			for (int j = 0; j < ROWS; j++) {
+		int nr = RollRandom(data) % matched;
+		for (int i = 0; i < data->cols; i++) {
+			for (int j = 0; j < data->rows; j++) {
 				if (data->fields[i][j].matched && data->fields[i][j].match_mark == mark) {
 					nr--;
 					if (nr < 0) {
@@ -65,8 +66,8 @@ void TurnMatchToSuper(struct Game* game, struct GamestateResources* data, int ma
 
 	TurnFieldToSuper(game, data, super);
 
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			if (data->fields[i][j].match_mark == mark) {
 				data->fields[i][j].match_mark = 0;
 				data->fields[i][j].animation.super = super;
@@ -80,7 +81,6 @@ static TM_ACTION(DoSpawnParticles) {
 	struct Field* field = TM_Arg(0);
 	int* count = TM_Arg(1);
 	SpawnParticles(game, data, field->id, *count);
-	AddScore(game, data, 10);
 	free(count);
 	return TM_END;
 }
@@ -113,13 +113,13 @@ static void LaunchSpecial(struct Game* game, struct GamestateResources* data, st
 	}
 	TM_WrapArg(int, count, 64);
 	TM_AddAction(data->timeline, DoSpawnParticles, TM_Args(GetField(game, data, id), count));
-	AddScore(game, data, 200);
+	AddScore(game, data, 200 + 10);
 }
 
 bool AnimateSpecials(struct Game* game, struct GamestateResources* data) {
 	bool found = false;
-	for (int i = 0; i < COLS; i++) {
-		for (int j = 0; j < ROWS; j++) {
+	for (int i = 0; i < data->cols; i++) {
+		for (int j = 0; j < data->rows; j++) {
 			if (data->fields[i][j].to_remove && !data->fields[i][j].handled) {
 				if (data->fields[i][j].type == FIELD_TYPE_ANIMAL && data->fields[i][j].data.animal.super) {
 					data->fields[i][j].handled = true;
@@ -135,7 +135,7 @@ bool AnimateSpecials(struct Game* game, struct GamestateResources* data) {
 TM_ACTION(AnimateSpecial) {
 	TM_RunningOnly;
 	struct Field* field = TM_Arg(0);
-	field->animation.launching = Tween(game, 0.0, 1.0, TWEEN_STYLE_SINE_IN_OUT, LAUNCHING_TIME);
+	StartFieldTween(game, data, field, &field->animation.launching, 0.0, 1.0, TWEEN_STYLE_SINE_IN_OUT, LAUNCHING_TIME);
 	return TM_END;
 }
 
@@ -143,9 +143,10 @@ void HandleSpecialed(struct Game* game, struct GamestateResources* data, struct
 	TM_WrapArg(int, count, 64);
 	TM_AddAction(data->timeline, DoSpawnParticles, TM_Args(field, count));
 	TM_AddDelay(data->timeline, 0.0333);
+	AddScore(game, data, 10);
 	if (field->type != FIELD_TYPE_FREEFALL && field->type != FIELD_TYPE_DISABLED) {
 		if (field->type == FIELD_TYPE_ANIMAL) {
-			SelectSpritesheet(game, field->drawable, ANIMAL_ACTIONS[field->data.animal.type].names[rand() % ANIMAL_ACTIONS[field->type].actions]);
+			SelectRandomAnimalAction(game, data, field);
 		}
 		field->to_remove = true;
 		field->to_highlight = true;
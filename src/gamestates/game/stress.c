@@ -0,0 +1,165 @@
+/*! \file stress.c
+ *  \brief Long running stress test of the infinite level.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+/*
+ * When started with --benchmark-stress[=file], the game plays the infinite level
+ * with AutoMove as fast as the animations let it, for as long as requested. It
+ * keeps track of turns per second, the longest frame, the peak number of live
+ * particles and queued timeline actions and the resident memory, then quits
+ * dumping them as JSON - both for the whole run and for every minute of it, so
+ * leaks and slowdowns that creep in over time are easy to spot.
+ */
+
+#define STRESS_SAMPLE_TIME 60.0
+
+static long ResidentMemory(void) {
+#ifdef __linux__
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (!file) {
+		return -1;
+	}
+	long size, resident;
+	int ret = fscanf(file, "%ld %ld", &size, &resident);
+	fclose(file);
+	if (ret != 2) {
+		return -1;
+	}
+	return resident * sysconf(_SC_PAGESIZE);
+#else
+	return -1;
+#endif
+}
+
+static int QueueLength(struct Timeline* timeline) {
+	int length = 0;
+	for (struct TM_Action* action = timeline->queue; action; action = action->next) {
+		length++;
+	}
+	return length;
+}
+
+void StartStressTest(struct Game* game, struct GamestateResources* data) {
+	struct StressTest* stress = &data->stress;
+	free(stress->samples);
+	*stress = (struct StressTest){0};
+	stress->start = al_get_time();
+	stress->last_frame = stress->start;
+	stress->last_sample = stress->start;
+	stress->start_rss = ResidentMemory();
+	stress->size = 64;
+	stress->samples = calloc(stress->size, sizeof(struct StressSample));
+	PrintConsole(game, "Stress test started.");
+}
+
+static void TakeSample(struct Game* game, struct GamestateResources* data, double now) {
+	struct StressTest* stress = &data->stress;
+	if (stress->count == stress->size) {
+		stress->size *= 2;
+		stress->samples = realloc(stress->samples, stress->size * sizeof(struct StressSample));
+	}
+	struct StressSample* sample = &stress->samples[stress->count++];
+	*sample = stress->sample;
+	sample->time = now - stress->start;
+	sample->turns_per_second = stress->sample_turns / (now - stress->last_sample);
+	sample->rss = ResidentMemory();
+	PrintConsole(game, "Stress test: %.0f s, %.2f turns/s, worst frame %.1f ms, %d particles, %d queued actions, RSS %ld kB",
+		sample->time, sample->turns_per_second, sample->worst_frame * 1000.0, sample->particles, sample->queue, sample->rss / 1024);
+
+	stress->sample = (struct StressSample){0};
+	stress->sample_turns = 0;
+	stress->last_sample = now;
+}
+
+static void FinishStressTest(struct Game* game, struct GamestateResources* data, double now) {
+	struct StressTest* stress = &data->stress;
+	struct Benchmark* benchmark = &game->data->benchmark;
+	stress->finished = true;
+	TakeSample(game, data, now);
+	long rss = stress->samples[stress->count - 1].rss;
+
+	FILE* file = stdout;
+	if (benchmark->stress_output) {
+		file = fopen(benchmark->stress_output, "w");
+		if (!file) {
+			PrintConsole(game, "Could not open benchmark output file: %s", benchmark->stress_output);
+			file = stdout;
+		}
+	}
+
+	fprintf(file, "{\n\t\"game\": \"%s\",\n\t\"version\": \"%s-%s\",\n", LIBSUPERDERPY_GAMENAME, LIBSUPERDERPY_GAME_VERSION, LIBSUPERDERPY_GAME_GIT_REV);
+	fprintf(file, "\t\"duration\": %.3f,\n\t\"speed\": %.3f,\n\t\"turns\": %ld,\n\t\"turns_per_second\": %.3f,\n\t\"worst_frame\": %.6f,\n",
+		now - stress->start, benchmark->stress_speed, stress->turns, stress->turns / (now - stress->start), stress->peak.worst_frame);
+	fprintf(file, "\t\"particles_peak\": %d,\n\t\"particles_cap\": %d,\n\t\"queue_peak\": %d,\n", stress->peak.particles, MAX_PARTICLES, stress->peak.queue);
+	fprintf(file, "\t\"rss_start\": %ld,\n\t\"rss_end\": %ld,\n\t\"rss_growth\": %ld,\n\t\"samples\": [\n", stress->start_rss, rss, (rss >= 0 && stress->start_rss >= 0) ? rss - stress->start_rss : 0);
+	for (int i = 0; i < stress->count; i++) {
+		struct StressSample* sample = &stress->samples[i];
+		fprintf(file, "\t\t{\"time\": %.3f, \"turns_per_second\": %.3f, \"worst_frame\": %.6f, \"particles\": %d, \"queue\": %d, \"rss\": %ld}%s\n",
+			sample->time, sample->turns_per_second, sample->worst_frame, sample->particles, sample->queue, sample->rss, (i < stress->count - 1) ? "," : "");
+	}
+	fprintf(file, "\t]\n}\n");
+
+	if (file != stdout) {
+		fclose(file);
+	} else {
+		fflush(file);
+	}
+
+	QuitGame(game, false);
+}
+
+void UpdateStressTest(struct Game* game, struct GamestateResources* data) {
+	struct StressTest* stress = &data->stress;
+	if (stress->finished || !stress->samples) {
+		return;
+	}
+
+	double now = al_get_time();
+	double frame = now - stress->last_frame;
+	stress->last_frame = now;
+
+	if (AutoMove(game, data)) {
+		stress->turns++;
+		stress->sample_turns++;
+	}
+
+	int queue = QueueLength(data->timeline);
+	stress->sample.worst_frame = fmax(stress->sample.worst_frame, frame);
+	stress->sample.particles = fmax(stress->sample.particles, data->particles->active);
+	stress->sample.queue = fmax(stress->sample.queue, queue);
+	stress->peak.worst_frame = fmax(stress->peak.worst_frame, frame);
+	stress->peak.particles = fmax(stress->peak.particles, data->particles->active);
+	stress->peak.queue = fmax(stress->peak.queue, queue);
+
+	if (now - stress->start >= game->data->benchmark.stress_duration) {
+		FinishStressTest(game, data, now);
+	} else if (now - stress->last_sample >= STRESS_SAMPLE_TIME) {
+		TakeSample(game, data, now);
+	}
+}
+
+void DestroyStressTest(struct Game* game, struct GamestateResources* data) {
+	free(data->stress.samples);
+	data->stress.samples = NULL;
+}
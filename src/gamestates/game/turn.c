@@ -0,0 +1,74 @@
+/*! \file turn.c
+ *  \brief Predicting and skipping turns.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * The rules of a turn run only once, for real, as the timeline gets to them
+ * (see logic.c). What the turn is going to end with is predicted as soon as
+ * the swap is made, by playing it out on a SimBoard (see simulation.c), which
+ * has no tweens, drawables or timeline actions to stay out of the way of.
+ *
+ * Refills are left unknown in the prediction, so it can only miss matches,
+ * never invent them: if it says the goals get reached, they will be. Swaps
+ * queued while the turn is shown are checked against it (see QueueTurn) and
+ * are checked again against the real board once they get to run.
+ *
+ * All the randomness the rules need comes from RollRandom, so the same swaps
+ * on the same board always play out the same way.
+ */
+
+#define SKIP_STEP 1.0 // seconds of the timeline run at once by SkipTurn
+#define SKIP_MAX_STEPS 1024
+
+int RollRandom(struct GamestateResources* data) {
+	return RollRandomState(&data->random);
+}
+
+int RollRandomState(uint64_t* state) {
+	// SplitMix64, which is tiny, fast and good enough for the rules
+	uint64_t x = (*state += 0x9E3779B97F4A7C15ULL);
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	x ^= x >> 31;
+	return (int)((x >> 33) % ((uint64_t)RAND_MAX + 1));
+}
+
+void PredictTurn(struct Game* game, struct GamestateResources* data, struct FieldID one, struct FieldID two, bool bad) {
+	struct Turn* turn = &data->turn;
+	TakeSnapshot(game, data, &turn->after);
+	if (!bad) {
+		SimulateMove(data, &turn->after, one, two, false);
+	}
+	turn->finishes = !data->infinite && AreSimGoalsReached(&turn->after);
+	turn->running = true;
+}
+
+bool SkipTurn(struct Game* game, struct GamestateResources* data) {
+	if (!data->turn.running) {
+		return false;
+	}
+	// the rest of the timeline gets run right away, without waiting for any of the animations
+	for (int i = 0; i < SKIP_MAX_STEPS && data->turn.running; i++) {
+		TM_Process(data->timeline, SKIP_STEP);
+	}
+	StopAnimations(game, data);
+	return true;
+}
@@ -76,35 +76,104 @@ void SpawnParticles(struct Game* game, struct GamestateResources* data, struct F
 	data->counter_speed = 2.0;
 }
 
+static struct Spritesheet* FindSpritesheet(struct Game* game, struct Character* character, const char* name) {
+	for (struct Spritesheet* spritesheet = character->spritesheets; spritesheet; spritesheet = spritesheet->next) {
+		if (strcmp(spritesheet->name, name) == 0) {
+			return spritesheet;
+		}
+	}
+	PrintConsole(game, "No spritesheet %s found for %s!", name, character->name);
+	return NULL;
+}
+
+void ResolveSpritesheets(struct Game* game, struct GamestateResources* data) {
+	for (enum ANIMAL_TYPE type = 0; type < ANIMAL_TYPES; type++) {
+		for (int i = 0; i < ANIMAL_ACTIONS[type].actions; i++) {
+			data->animal_spritesheets[type][i] = FindSpritesheet(game, data->animal_archetypes[type], ANIMAL_ACTIONS[type].names[i]);
+		}
+		data->animal_spritesheets[type][ANIMAL_SPRITESHEET_STAND] = FindSpritesheet(game, data->animal_archetypes[type], "stand");
+		data->animal_spritesheets[type][ANIMAL_SPRITESHEET_BLINK] = FindSpritesheet(game, data->animal_archetypes[type], "blink");
+		data->animal_spritesheets[type][ANIMAL_SPRITESHEET_SUPER] = FindSpritesheet(game, data->special_archetypes[SPECIAL_TYPE_SUPER], StrToLower(game, ANIMALS[type]));
+	}
+	for (enum SPECIAL_TYPE type = 0; type < SPECIAL_TYPES; type++) {
+		for (int i = 0; i < SPECIAL_ACTIONS[type].actions; i++) {
+			data->special_spritesheets[type][i] = FindSpritesheet(game, data->special_archetypes[type], SPECIAL_ACTIONS[type].names[i]);
+		}
+	}
+}
+
+static void SelectSpritesheetHandle(struct Game* game, struct Character* character, struct Spritesheet* spritesheet) {
+	// the handle carries its own name, so nothing has to be built or copied to select it;
+	// the engine still does the selecting, so the character is reset the way it expects
+	SelectSpritesheet(game, character, spritesheet->name);
+}
+
+static void ShowSpritesheet(struct Game* game, struct Character* character, struct Character* archetype, struct Spritesheet* spritesheet) {
+	if (!spritesheet) {
+		return;
+	}
+	if (character->spritesheets != archetype->spritesheets) {
+		free(character->name);
+		character->name = strdup(archetype->name);
+		character->spritesheets = archetype->spritesheets;
+		character->spritesheet = NULL;
+	}
+	if (character->spritesheet != spritesheet) {
+		SelectSpritesheetHandle(game, character, spritesheet);
+	}
+}
+
+void SelectAnimalSpritesheet(struct Game* game, struct GamestateResources* data, struct Field* field, enum ANIMAL_SPRITESHEET spritesheet) {
+	struct Spritesheet* handle = data->animal_spritesheets[field->data.animal.type][spritesheet];
+	if (!handle || field->drawable->spritesheets != data->animal_archetypes[field->data.animal.type]->spritesheets) {
+		// super animals are drawn with another archetype that has none of these
+		return;
+	}
+	// restarts the animation even if it's already playing
+	SelectSpritesheetHandle(game, field->drawable, handle);
+}
+
+void SelectRandomAnimalAction(struct Game* game, struct GamestateResources* data, struct Field* field) {
+	SelectAnimalSpritesheet(game, data, field, rand() % ANIMAL_ACTIONS[field->data.animal.type].actions);
+}
+
+bool IsStanding(struct Game* game, struct GamestateResources* data, struct Field* field) {
+	struct Spritesheet* stand = NULL;
+	switch (field->type) {
+		case FIELD_TYPE_ANIMAL:
+			stand = data->animal_spritesheets[field->data.animal.type][ANIMAL_SPRITESHEET_STAND];
+			break;
+		case FIELD_TYPE_COLLECTIBLE:
+			stand = data->special_spritesheets[FIRST_COLLECTIBLE + field->data.collectible.type][0];
+			break;
+		case FIELD_TYPE_FREEFALL:
+			stand = data->special_spritesheets[SPECIAL_TYPE_EGG][0];
+			break;
+		default:
+			break;
+	}
+	return stand && field->drawable->spritesheet == stand;
+}
+
 static void UpdateOverlay(struct Game* game, struct GamestateResources* data, struct FieldID id) {
 	struct Field* field = GetField(game, data, id);
 	if (!IsDrawable(field->type)) {
 		return;
 	}
-	char *name = NULL, *anim = NULL;
-	int index = -1;
+	int index = -1, action = 0;
 	if (field->type == FIELD_TYPE_ANIMAL) {
 		if (field->data.animal.super) {
-			name = "eyes";
-			anim = "eyes";
 			index = SPECIAL_TYPE_EYES;
+			action = 0; // eyes
 		}
 		if (field->data.animal.sleeping) {
-			name = "cloud";
-			anim = field->data.animal.type == ANIMAL_TYPE_BIRD ? "anim2" : "anim";
 			index = SPECIAL_TYPE_CLOUD;
+			action = field->data.animal.type == ANIMAL_TYPE_BIRD ? 1 : 0; // anim2 : anim
 		}
 	}
 
-	if (name) {
-		struct Character* archetype = data->special_archetypes[index];
-		if (field->overlay->name) {
-			free(field->overlay->name);
-		}
-		field->overlay->name = strdup(archetype->name);
-		field->overlay->spritesheets = archetype->spritesheets;
-
-		SelectSpritesheet(game, field->overlay, anim);
+	if (index >= 0) {
+		ShowSpritesheet(game, field->overlay, data->special_archetypes[index], data->special_spritesheets[index][action]);
 		field->overlay_visible = true;
 	} else {
 		field->overlay_visible = false;
@@ -117,48 +186,34 @@ void UpdateDrawable(struct Game* game, struct GamestateResources* data, struct F
 		return;
 	}
 
-	char* name = "stand";
-	if (IsSleeping(field)) {
-		name = "blink";
-	}
-
 	struct Character* archetype = NULL;
-	int index = 0;
+	struct Spritesheet* spritesheet = NULL;
 	if (field->type == FIELD_TYPE_FREEFALL) {
-		index = SPECIAL_TYPE_EGG;
-		name = SPECIAL_ACTIONS[index].names[field->data.freefall.variant];
-
-		archetype = data->special_archetypes[index];
+		archetype = data->special_archetypes[SPECIAL_TYPE_EGG];
+		spritesheet = data->special_spritesheets[SPECIAL_TYPE_EGG][field->data.freefall.variant];
 	} else if (field->type == FIELD_TYPE_COLLECTIBLE) {
-		index = FIRST_COLLECTIBLE + field->data.collectible.type;
+		int index = FIRST_COLLECTIBLE + field->data.collectible.type;
 		int variant = field->data.collectible.variant;
 		if (variant == SPECIAL_ACTIONS[index].actions) {
 			variant--;
 		}
-		name = SPECIAL_ACTIONS[index].names[variant];
-
 		archetype = data->special_archetypes[index];
+		spritesheet = data->special_spritesheets[index][variant];
 	} else if (field->type == FIELD_TYPE_ANIMAL) {
-		index = field->data.animal.type;
+		enum ANIMAL_TYPE type = field->data.animal.type;
 		if (field->data.animal.super) {
-			index = SPECIAL_TYPE_SUPER;
-			name = StrToLower(game, ANIMALS[field->data.animal.type]);
-			archetype = data->special_archetypes[index];
+			archetype = data->special_archetypes[SPECIAL_TYPE_SUPER];
+			spritesheet = data->animal_spritesheets[type][ANIMAL_SPRITESHEET_SUPER];
 		} else {
-			archetype = data->animal_archetypes[index];
+			archetype = data->animal_archetypes[type];
+			spritesheet = data->animal_spritesheets[type][IsSleeping(field) ? ANIMAL_SPRITESHEET_BLINK : ANIMAL_SPRITESHEET_STAND];
 		}
 	} else {
 		PrintConsole(game, "Incorrect drawable!");
 		return;
 	}
 
-	if (field->drawable->name) {
-		free(field->drawable->name);
-	}
-	field->drawable->name = strdup(archetype->name);
-	field->drawable->spritesheets = archetype->spritesheets;
-
-	SelectSpritesheet(game, field->drawable, name);
+	ShowSpritesheet(game, field->drawable, archetype, spritesheet);
 
 	UpdateOverlay(game, data, id);
 }
@@ -166,7 +221,23 @@ void UpdateDrawable(struct Game* game, struct GamestateResources* data, struct F
 void DrawField(struct Game* game, struct GamestateResources* data, struct FieldID id) {
 	struct Field* field = GetField(game, data, id);
 
-	int offsetY = (int)((game->viewport.height - (ROWS * 90)) / 2.0);
+	struct Field ahead;
+	if (data->animating.listed[id.i][id.j] && data->logic.remainder > 0.0) {
+		// the tweens have been updated at the last logic step, so bring them forward
+		// by the time that has passed since then to keep the motion smooth
+		double delta = data->logic.remainder * (game->data->config.fast_cascades ? FAST_CASCADES_SPEED : 1.0);
+		ahead = *field;
+		UpdateTween(&ahead.animation.hiding, delta);
+		UpdateTween(&ahead.animation.falling, delta);
+		UpdateTween(&ahead.animation.collecting, delta);
+		UpdateTween(&ahead.animation.swapping, delta);
+		UpdateTween(&ahead.animation.shaking, delta);
+		UpdateTween(&ahead.animation.hinting, delta);
+		UpdateTween(&ahead.animation.launching, delta);
+		field = &ahead;
+	}
+
+	float size = data->cell.size, half = size / 2.0;
 
 	float tint = 1.0 - GetTweenValue(&field->animation.hiding);
 	if (IsDrawable(field->type)) {
@@ -178,12 +249,12 @@ void DrawField(struct Game* game, struct GamestateResources* data, struct FieldI
 	float tween = Interpolate(GetTweenPosition(&field->animation.falling), TWEEN_STYLE_EXPONENTIAL_OUT) * (0.5 - level_no * 0.1) +
 		sqrt(Interpolate(GetTweenPosition(&field->animation.falling), TWEEN_STYLE_BOUNCE_OUT)) * (0.5 + level_no * 0.1);
 
-	int levelDiff = (int)(levels * 90 * (1.0 - tween));
+	int levelDiff = (int)(levels * size * (1.0 - tween));
 
-	int x = field->id.i * 90 + 45, y = field->id.j * 90 + 45 + offsetY - levelDiff;
+	int x = data->cell.x + field->id.i * size + half, y = data->cell.y + field->id.j * size + half - levelDiff;
 	y -= (int)(sin(GetTweenValue(&field->animation.collecting) * ALLEGRO_PI) * 10);
 	if (IsValidID(field->animation.super)) {
-		int superX = field->animation.super.i * 90 + 45, superY = field->animation.super.j * 90 + 45 + offsetY;
+		int superX = data->cell.x + field->animation.super.i * size + half, superY = data->cell.y + field->animation.super.j * size + half;
 
 		double val = Interpolate(Clamp(0.0, 1.0, GetTweenValue(&field->animation.hiding) * 1.5 - 0.5), TWEEN_STYLE_QUARTIC_IN);
 
@@ -191,7 +262,7 @@ void DrawField(struct Game* game, struct GamestateResources* data, struct FieldI
 			SetCharacterPosition(game, field->drawable, Lerp(x, superX, val), Lerp(y, superY, val), 0);
 		}
 	} else {
-		int swapeeX = field->animation.swapee.i * 90 + 45, swapeeY = field->animation.swapee.j * 90 + 45 + offsetY;
+		int swapeeX = data->cell.x + field->animation.swapee.i * size + half, swapeeY = data->cell.y + field->animation.swapee.j * size + half;
 
 		if (IsDrawable(field->type)) {
 			SetCharacterPosition(game, field->drawable, Lerp(x, swapeeX, GetTweenValue(&field->animation.swapping)), Lerp(y, swapeeY, GetTweenValue(&field->animation.swapping)), 0);
@@ -201,12 +272,20 @@ void DrawField(struct Game* game, struct GamestateResources* data, struct FieldI
 	if (IsDrawable(field->type)) {
 		al_set_shader_float("saturation", IsSleeping(field) ? 0.333 : 1.0);
 		field->drawable->angle = sin(GetTweenValue(&field->animation.shaking) * 3 * ALLEGRO_PI) / 6.0 + sin(GetTweenValue(&field->animation.hinting) * 5 * ALLEGRO_PI) / 6.0 + sin(GetTweenPosition(&field->animation.collecting) * 2 * ALLEGRO_PI) / 12.0 + sin(GetTweenValue(&field->animation.launching) * 5 * ALLEGRO_PI) / 6.0;
-		field->drawable->scaleX = 1.0 + sin(GetTweenValue(&field->animation.hinting) * ALLEGRO_PI) / 3.0 + sin(GetTweenValue(&field->animation.launching) * ALLEGRO_PI) / 3.0;
+		field->drawable->scaleX = (1.0 + sin(GetTweenValue(&field->animation.hinting) * ALLEGRO_PI) / 3.0 + sin(GetTweenValue(&field->animation.launching) * ALLEGRO_PI) / 3.0) * size / FIELD_SIZE;
 		field->drawable->scaleY = field->drawable->scaleX;
 		DrawCharacter(game, field->drawable);
 	}
 }
 
+void UpdateLayout(struct Game* game, struct GamestateResources* data) {
+	// the board fills a square area as wide as the screen, fitting the level's dimensions
+	data->cell.size = fmin(game->viewport.width / (float)data->cols, DEFAULT_ROWS * FIELD_SIZE / (float)data->rows);
+	data->cell.x = (int)((game->viewport.width - data->cols * data->cell.size) / 2.0);
+	data->cell.y = (int)((game->viewport.height - data->rows * data->cell.size) / 2.0);
+	data->hit.valid = false;
+}
+
 void DrawOverlay(struct Game* game, struct GamestateResources* data, struct FieldID id) {
 	struct Field* field = GetField(game, data, id);
 	if (IsDrawable(field->type)) {
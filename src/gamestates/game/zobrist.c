@@ -0,0 +1,105 @@
+/*! \file zobrist.c
+ *  \brief Zobrist hashing of the board state.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.h"
+
+/*
+ * Instead of keeping a table of random keys, every key is derived from the
+ * field position and state with a SplitMix64 finalizer. That's as good for
+ * hashing purposes, needs no initialization and is safe to use from any thread.
+ *
+ * The hash of the actual board is maintained incrementally: every field
+ * remembers the key it currently contributes, so after any change of its
+ * logical state UpdateFieldHash just swaps the old key for the new one.
+ * HashBoard recomputes it from scratch, which lets the debug toolbox spot
+ * places that forget to do that. The field counts used by the generator
+ * are kept up to date on the same occasion.
+ */
+
+static inline uint64_t Mix(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+uint64_t ZobristKey(int i, int j, enum FIELD_TYPE type, int subtype, int variant, bool sleeping, bool super) {
+	uint64_t state = j * MAX_COLS + i;
+	state = state * FIELD_TYPES + type;
+	state = (state << 8) | (subtype & 0xFF);
+	state = (state << 8) | (variant & 0xFF);
+	state = (state << 2) | (sleeping << 1) | super;
+	return Mix(state);
+}
+
+uint64_t HashSimBoard(struct SimBoard* board) {
+	uint64_t hash = 0;
+	for (int i = 0; i < board->cols; i++) {
+		for (int j = 0; j < board->rows; j++) {
+			struct SimField* field = &board->fields[i][j];
+			// unknown fields don't have a subtype yet
+			hash ^= ZobristKey(i, j, field->type, field->unknown ? 0xFF : field->subtype, field->variant, field->sleeping, field->super);
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		hash ^= Mix(((uint64_t)(i + 1) << 56) ^ ((uint64_t)board->goals[i].type << 32) ^ (uint32_t)board->goals[i].value);
+	}
+	return hash;
+}
+
+static uint64_t FieldKey(struct Field* field) {
+	int subtype = 0, variant = 0;
+	bool sleeping = false, super = false;
+	switch (field->type) {
+		case FIELD_TYPE_ANIMAL:
+			subtype = field->data.animal.type;
+			sleeping = field->data.animal.sleeping;
+			super = field->data.animal.super;
+			break;
+		case FIELD_TYPE_COLLECTIBLE:
+			subtype = field->data.collectible.type;
+			variant = field->data.collectible.variant;
+			break;
+		case FIELD_TYPE_FREEFALL:
+			variant = field->data.freefall.variant;
+			break;
+		default:
+			break;
+	}
+	return ZobristKey(field->id.i, field->id.j, field->type, subtype, variant, sleeping, super);
+}
+
+void UpdateFieldHash(struct Game* game, struct GamestateResources* data, struct Field* field) {
+	uint64_t key = FieldKey(field);
+	data->hash ^= field->hash ^ key;
+	field->hash = key;
+	UpdateFieldCounts(game, data, field);
+}
+
+uint64_t HashBoard(struct Game* game, struct GamestateResources* data) {
+	uint64_t hash = 0;
+	// disabled fields outside of the board contribute to the hash too
+	for (int i = 0; i < MAX_COLS; i++) {
+		for (int j = 0; j < MAX_ROWS; j++) {
+			hash ^= FieldKey(&data->fields[i][j]);
+		}
+	}
+	return hash;
+}
@@ -43,9 +43,12 @@ int Gamestate_ProgressCount = 26; // number of loading steps as reported by Game
 
 void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double delta) {
 	// Here you should do all your game logic as if <delta> seconds have passed.
+	UpdateScrollingViewport(game, &data->menu, delta);
+	UpdateScrollingViewport(game, &data->credits, delta);
+
 	if (!game->data->config.less_movement) {
 		AnimateCharacter(game, data->beetle, delta, 1.0);
-		AnimateCharacter(game, data->snail, data->scrolling ? delta : (delta * sqrt(fabs(data->about ? data->credits.speed : data->menu.speed))), 1.0);
+		AnimateCharacter(game, data->snail, data->scrolling ? delta : (delta * sqrt(fabs(data->about ? data->credits.speed : data->menu.speed) / (60.0 * game->viewport.height))), 1.0);
 		AnimateCharacter(game, data->frog, delta, 1.0);
 	}
 
@@ -69,11 +72,6 @@ void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double
 	data->back->frame = &data->back->spritesheet->frames[0];
 }
 
-void Gamestate_Tick(struct Game* game, struct GamestateResources* data) {
-	UpdateScrollingViewport(game, &data->menu);
-	UpdateScrollingViewport(game, &data->credits);
-}
-
 void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 	// Draw everything to the screen here.
 
@@ -94,7 +92,10 @@ void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 	if (!data->about) {
 		SetScrollingViewportAsTarget(game, &data->menu);
 
-		for (int i = 1; i <= data->levels; i++) {
+		// only the rows that intersect the viewport, plus one on each side for leaves sticking out of theirs
+		int first = fmax(0, floor((data->menu.pos - 25) / 175.0) - 1);
+		int last = fmin(ceil(data->levels / 3.0) - 1, floor((data->menu.pos + data->menu.h - 25) / 175.0) + 1);
+		for (int i = first * 3 + 1; i <= fmin((last + 1) * 3, data->levels); i++) {
 			int ii = i - 1;
 			if (i > game->data->unlocked_levels) {
 				al_draw_tinted_bitmap(((ii / 3) % 2) ? data->leaf1b : data->leaf2b, al_map_rgba_f(0.4, 0.4, 0.4, 0.4), 50 + 150 * (ii % 3), 25 + 175 * floor(ii / 3.0), 0);
@@ -144,6 +145,8 @@ void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 	DrawCharacter(game, data->beetle);
 	DrawUIElement(game, data->ui, UI_ELEMENT_SETTINGS);
 	DrawUIElement(game, data->ui, UI_ELEMENT_ABOUT);
+
+	FinishBenchmark(game);
 }
 
 static int WhichLevel(struct Game* game, struct GamestateResources* data) {
@@ -272,54 +275,50 @@ void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
 	// NOTE: There's no OpenGL context available here. If you want to prerender something,
 	// create VBOs, etc. do it in Gamestate_PostLoad.
 
+	double start = al_get_time();
+	BenchmarkProgress(game, "menu", &progress);
+
 	struct GamestateResources* data = calloc(1, sizeof(struct GamestateResources));
-	data->bg = al_load_bitmap(GetDataFilePath(game, "bg.webp"));
+	data->bg = LoadCachedBitmap(game, "bg.webp");
 	progress(game); // report that we progressed with the loading, so the engine can move a progress bar
 
-	data->logo = al_load_bitmap(GetDataFilePath(game, "logo.webp"));
+	data->logo = LoadCachedBitmap(game, "logo.webp");
 	progress(game);
 
-	data->frame = al_load_bitmap(GetDataFilePath(game, "frame.webp"));
+	data->frame = LoadCachedBitmap(game, "frame.webp");
 
-	for (int i = 0; i < 621; i++) {
-		int offset = -1;
-		ALLEGRO_COLOR color;
-		do {
-			offset++;
-			color = al_get_pixel(data->frame, 614 + offset - 30, 412 + i - 315);
-		} while (color.a < 0.9);
-		data->snail_offset[i] = offset;
-	}
+	// how far the inner edge of the frame is from the scrollbar, for the snail to crawl along
+	LoadCachedEdgeProfile(game, "frame.webp", data->frame, 614 - 30, 412 - 315, 621, 0.9, data->snail_offset);
 
 	progress(game);
 
-	data->framebg = al_load_bitmap(GetDataFilePath(game, "frame_bg.webp"));
+	data->framebg = LoadCachedBitmap(game, "frame_bg.webp");
 	progress(game);
 
-	data->leaf = al_load_bitmap(GetDataFilePath(game, "leaf.webp"));
+	data->leaf = LoadCachedBitmap(game, "leaf.webp");
 	progress(game);
 
-	data->leaf1 = al_load_bitmap(GetDataFilePath(game, "leaf1.webp"));
+	data->leaf1 = LoadCachedBitmap(game, "leaf1.webp");
 	progress(game);
 
-	data->leaf2 = al_load_bitmap(GetDataFilePath(game, "leaf2.webp"));
+	data->leaf2 = LoadCachedBitmap(game, "leaf2.webp");
 	progress(game);
 
-	data->leaf1b = al_load_bitmap(GetDataFilePath(game, "listek1_bw.webp"));
+	data->leaf1b = LoadCachedBitmap(game, "listek1_bw.webp");
 	progress(game);
 
-	data->leaf2b = al_load_bitmap(GetDataFilePath(game, "listek2_bw2.webp"));
+	data->leaf2b = LoadCachedBitmap(game, "listek2_bw2.webp");
 	progress(game);
 
-	data->infinitybmp = al_load_bitmap(GetDataFilePath(game, "przycisk_nieskonczonosc_on.webp"));
+	data->infinitybmp = LoadCachedBitmap(game, "przycisk_nieskonczonosc_on.webp");
 	data->infinity = CreateCharacter(game, "infinity");
 	RegisterSpritesheetFromBitmap(game, data->infinity, "infinity", data->infinitybmp);
 	LoadSpritesheets(game, data->infinity, progress);
 	SelectSpritesheet(game, data->infinity, "infinity");
 	SetCharacterPosition(game, data->infinity, game->viewport.width - al_get_bitmap_width(data->infinitybmp) / 2.0 - 20, game->viewport.height - al_get_bitmap_height(data->infinitybmp) / 2.0 - 40, 0);
 
-	data->back_onbmp = al_load_bitmap(GetDataFilePath(game, "przycisk_do_tylu_on.webp"));
-	data->back_offbmp = al_load_bitmap(GetDataFilePath(game, "przycisk_do_tylu_off.webp"));
+	data->back_onbmp = LoadCachedBitmap(game, "przycisk_do_tylu_on.webp");
+	data->back_offbmp = LoadCachedBitmap(game, "przycisk_do_tylu_off.webp");
 	data->back = CreateCharacter(game, "back");
 	RegisterSpritesheetFromBitmap(game, data->back, "back_off", data->back_offbmp);
 	RegisterSpritesheetFromBitmap(game, data->back, "back_on", data->back_onbmp);
@@ -363,6 +362,7 @@ void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
 	progress(game);
 
 	data->menu.pos = 0;
+	BenchmarkStage(game, "menu/Gamestate_Load", start, al_get_time());
 	return data;
 }
 
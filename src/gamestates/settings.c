@@ -27,7 +27,7 @@ struct GamestateResources {
 	ALLEGRO_BITMAP *bg, *back_onbmp, *back_offbmp, *frame, *frame_bg;
 	ALLEGRO_FONT* font;
 	struct Character *back, *animals[6];
-	bool back_hover, transitions, allow_continue, less_movement, solid_backgrounds, reset_progress;
+	bool back_hover, transitions, allow_continue, less_movement, fast_cascades, solid_backgrounds, reset_progress;
 };
 
 int Gamestate_ProgressCount = 18; // number of loading steps as reported by Gamestate_Load; 0 when missing
@@ -36,16 +36,17 @@ static void UpdateAnimals(struct Game* game, struct GamestateResources* data) {
 	SelectSpritesheet(game, data->animals[0], data->transitions ? "stand" : "blink");
 	SelectSpritesheet(game, data->animals[1], data->allow_continue ? "stand" : "blink");
 	SelectSpritesheet(game, data->animals[2], data->less_movement ? "stand" : "blink");
-	SelectSpritesheet(game, data->animals[3], data->solid_backgrounds ? "stand" : "blink");
-	SelectSpritesheet(game, data->animals[4], data->reset_progress ? "stand" : "blink");
-	SelectSpritesheet(game, data->animals[5], "stand");
+	SelectSpritesheet(game, data->animals[3], data->fast_cascades ? "stand" : "blink");
+	SelectSpritesheet(game, data->animals[4], data->solid_backgrounds ? "stand" : "blink");
+	SelectSpritesheet(game, data->animals[5], data->reset_progress ? "stand" : "blink");
 
 	ALLEGRO_COLOR color_on = al_map_rgb(255, 255, 255), color_off = al_map_rgba(100, 100, 100, 100);
 	data->animals[0]->tint = data->transitions ? color_on : color_off;
 	data->animals[1]->tint = data->allow_continue ? color_on : color_off;
 	data->animals[2]->tint = data->less_movement ? color_on : color_off;
-	data->animals[3]->tint = data->solid_backgrounds ? color_on : color_off;
-	data->animals[4]->tint = data->reset_progress ? color_on : color_off;
+	data->animals[3]->tint = data->fast_cascades ? color_on : color_off;
+	data->animals[4]->tint = data->solid_backgrounds ? color_on : color_off;
+	data->animals[5]->tint = data->reset_progress ? color_on : color_off;
 }
 
 void Gamestate_Logic(struct Game* game, struct GamestateResources* data, double delta) {
@@ -67,18 +68,19 @@ void Gamestate_Draw(struct Game* game, struct GamestateResources* data) {
 	}
 	DrawCharacter(game, data->back);
 	ALLEGRO_COLOR color_on = al_map_rgb(0, 0, 0), color_off = al_map_rgb(130, 130, 130);
-	al_draw_text(data->font, data->transitions ? color_on : color_off, game->viewport.width / 2.0, 400, ALLEGRO_ALIGN_CENTER, "animated transitions");
-	al_draw_text(data->font, data->allow_continue ? color_on : color_off, game->viewport.width / 2.0, 550, ALLEGRO_ALIGN_CENTER, "continue after losing");
-	al_draw_text(data->font, data->less_movement ? color_on : color_off, game->viewport.width / 2.0, 700, ALLEGRO_ALIGN_CENTER, "less movement");
-	al_draw_text(data->font, data->solid_backgrounds ? color_on : color_off, game->viewport.width / 2.0, 850, ALLEGRO_ALIGN_CENTER, "solid backgrounds");
-	al_draw_text(data->font, data->reset_progress ? color_on : color_off, game->viewport.width / 2.0, 1000, ALLEGRO_ALIGN_CENTER, "reset progress");
+	al_draw_text(data->font, data->transitions ? color_on : color_off, game->viewport.width / 2.0, 380, ALLEGRO_ALIGN_CENTER, "animated transitions");
+	al_draw_text(data->font, data->allow_continue ? color_on : color_off, game->viewport.width / 2.0, 510, ALLEGRO_ALIGN_CENTER, "continue after losing");
+	al_draw_text(data->font, data->less_movement ? color_on : color_off, game->viewport.width / 2.0, 640, ALLEGRO_ALIGN_CENTER, "less movement");
+	al_draw_text(data->font, data->fast_cascades ? color_on : color_off, game->viewport.width / 2.0, 770, ALLEGRO_ALIGN_CENTER, "fast cascades");
+	al_draw_text(data->font, data->solid_backgrounds ? color_on : color_off, game->viewport.width / 2.0, 900, ALLEGRO_ALIGN_CENTER, "solid backgrounds");
+	al_draw_text(data->font, data->reset_progress ? color_on : color_off, game->viewport.width / 2.0, 1030, ALLEGRO_ALIGN_CENTER, "reset progress");
 
-	for (int i = 0; i < 5; i++) {
+	for (int i = 0; i < 6; i++) {
 		data->animals[i]->scaleX = 0.9;
 		data->animals[i]->scaleY = 0.9;
-		SetCharacterPosition(game, data->animals[i], 80, 440 + i * 150, 0);
+		SetCharacterPosition(game, data->animals[i], 80, 420 + i * 130, 0);
 		DrawCharacter(game, data->animals[i]);
-		SetCharacterPosition(game, data->animals[i], 640, 440 + i * 150, 0);
+		SetCharacterPosition(game, data->animals[i], 640, 420 + i * 130, 0);
 		DrawCharacter(game, data->animals[i]);
 	}
 
@@ -119,24 +121,28 @@ void Gamestate_ProcessEvent(struct Game* game, struct GamestateResources* data,
 			data->back_hover = true;
 		}
 
-		if ((game->data->mouseY * game->viewport.height > 400 - 40) && (game->data->mouseY * game->viewport.height < 400 + 110)) {
+		if ((game->data->mouseY * game->viewport.height > 380 - 30) && (game->data->mouseY * game->viewport.height < 380 + 100)) {
 			data->transitions = !data->transitions;
 			game->data->config.animated_transitions = data->transitions;
 			UpdateAnimals(game, data);
 		}
-		if ((game->data->mouseY * game->viewport.height > 550 - 40) && (game->data->mouseY * game->viewport.height < 550 + 110)) {
+		if ((game->data->mouseY * game->viewport.height > 510 - 30) && (game->data->mouseY * game->viewport.height < 510 + 100)) {
 			data->allow_continue = !data->allow_continue;
 			UpdateAnimals(game, data);
 		}
-		if ((game->data->mouseY * game->viewport.height > 700 - 40) && (game->data->mouseY * game->viewport.height < 700 + 110)) {
+		if ((game->data->mouseY * game->viewport.height > 640 - 30) && (game->data->mouseY * game->viewport.height < 640 + 100)) {
 			data->less_movement = !data->less_movement;
 			UpdateAnimals(game, data);
 		}
-		if ((game->data->mouseY * game->viewport.height > 850 - 40) && (game->data->mouseY * game->viewport.height < 850 + 110)) {
+		if ((game->data->mouseY * game->viewport.height > 770 - 30) && (game->data->mouseY * game->viewport.height < 770 + 100)) {
+			data->fast_cascades = !data->fast_cascades;
+			UpdateAnimals(game, data);
+		}
+		if ((game->data->mouseY * game->viewport.height > 900 - 30) && (game->data->mouseY * game->viewport.height < 900 + 100)) {
 			data->solid_backgrounds = !data->solid_backgrounds;
 			UpdateAnimals(game, data);
 		}
-		if ((game->data->mouseY * game->viewport.height > 1000 - 40) && (game->data->mouseY * game->viewport.height < 1000 + 110)) {
+		if ((game->data->mouseY * game->viewport.height > 1030 - 30) && (game->data->mouseY * game->viewport.height < 1030 + 100)) {
 			data->reset_progress = !data->reset_progress;
 			UpdateAnimals(game, data);
 		}
@@ -158,14 +164,17 @@ void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
 	// Keep in mind that there's no OpenGL context available here. If you want to prerender something,
 	// create VBOs, etc. do it in Gamestate_PostLoad.
 
+	double start = al_get_time();
+	BenchmarkProgress(game, "settings", &progress);
+
 	struct GamestateResources* data = calloc(1, sizeof(struct GamestateResources));
 
-	data->bg = al_load_bitmap(GetDataFilePath(game, "bg.webp"));
+	data->bg = LoadCachedBitmap(game, "bg.webp");
 
 	progress(game); // report that we progressed with the loading, so the engine can move a progress bar
 
-	data->back_onbmp = al_load_bitmap(GetDataFilePath(game, "przycisk_do_tylu_on.webp"));
-	data->back_offbmp = al_load_bitmap(GetDataFilePath(game, "przycisk_do_tylu_off.webp"));
+	data->back_onbmp = LoadCachedBitmap(game, "przycisk_do_tylu_on.webp");
+	data->back_offbmp = LoadCachedBitmap(game, "przycisk_do_tylu_off.webp");
 	data->back = CreateCharacter(game, "back");
 	RegisterSpritesheetFromBitmap(game, data->back, "back_on", data->back_onbmp);
 	LoadSpritesheets(game, data->back, progress);
@@ -191,11 +200,12 @@ void* Gamestate_Load(struct Game* game, void (*progress)(struct Game*)) {
 		LoadSpritesheets(game, data->animals[i], progress);
 	}
 
-	data->frame = al_load_bitmap(GetDataFilePath(game, "frame_small.webp"));
+	data->frame = LoadCachedBitmap(game, "frame_small.webp");
 	progress(game);
 
-	data->frame_bg = al_load_bitmap(GetDataFilePath(game, "frame_small_bg.webp"));
+	data->frame_bg = LoadCachedBitmap(game, "frame_small_bg.webp");
 	progress(game);
+	BenchmarkStage(game, "settings/Gamestate_Load", start, al_get_time());
 	return data;
 }
 
@@ -221,6 +231,7 @@ void Gamestate_Start(struct Game* game, struct GamestateResources* data) {
 	data->back_hover = false;
 
 	data->less_movement = game->data->config.less_movement;
+	data->fast_cascades = game->data->config.fast_cascades;
 	data->solid_backgrounds = game->data->config.solid_background;
 	data->allow_continue = game->data->config.allow_continuing;
 	data->transitions = game->data->config.animated_transitions;
@@ -232,18 +243,20 @@ void Gamestate_Start(struct Game* game, struct GamestateResources* data) {
 void Gamestate_Stop(struct Game* game, struct GamestateResources* data) {
 	// Called when gamestate gets stopped. Stop timers, music etc. here.
 	SetConfigOption(game, "Animatch", "less_movement", data->less_movement ? "1" : "0");
+	SetConfigOption(game, "Animatch", "fast_cascades", data->fast_cascades ? "1" : "0");
 	SetConfigOption(game, "Animatch", "solid_background", data->solid_backgrounds ? "1" : "0");
 	SetConfigOption(game, "Animatch", "allow_continuing", data->allow_continue ? "1" : "0");
 	SetConfigOption(game, "Animatch", "animated_transitions", data->transitions ? "1" : "0");
 	if (data->reset_progress) {
-		SetConfigOption(game, "Animatch", "unlocked_levels", "1");
-		game->data->unlocked_levels = 1;
+		ResetProgress(game, &game->data->progress);
+		game->data->unlocked_levels = CountUnlockedLevels(game, &game->data->progress);
 	}
 	if (data->solid_backgrounds != game->data->config.solid_background) {
 		UnloadGamestate(game, "game");
 		LoadGamestate(game, "game");
 	}
 	game->data->config.less_movement = data->less_movement;
+	game->data->config.fast_cascades = data->fast_cascades;
 	game->data->config.solid_background = data->solid_backgrounds;
 	game->data->config.allow_continuing = data->allow_continue;
 	game->data->config.animated_transitions = data->transitions;
@@ -21,8 +21,17 @@
 #include "common.h"
 
 int main(int argc, char** argv) {
+	double launch = BenchmarkClock();
 	srand(time(NULL));
 
+	char *benchmark_output = NULL, *board_output = NULL, *baseline = NULL, *stress_output = NULL, *minutes = NULL, *speed = NULL;
+	bool benchmark = ParseBenchmarkArgs(&argc, argv, "--benchmark-startup", &benchmark_output);
+	bool board_benchmark = ParseBenchmarkArgs(&argc, argv, "--benchmark-board", &board_output);
+	ParseBenchmarkArgs(&argc, argv, "--benchmark-baseline", &baseline);
+	bool stress_benchmark = ParseBenchmarkArgs(&argc, argv, "--benchmark-stress", &stress_output);
+	ParseBenchmarkArgs(&argc, argv, "--benchmark-minutes", &minutes);
+	ParseBenchmarkArgs(&argc, argv, "--benchmark-speed", &speed);
+
 	al_set_org_name("Holy Pangolin");
 	al_set_app_name(LIBSUPERDERPY_GAMENAME_PRETTY);
 
@@ -41,13 +50,31 @@ int main(int argc, char** argv) {
 
 	if (!game) { return 1; }
 
+	double start = al_get_time();
+	game->data = CreateGameData(game);
+	if (benchmark) {
+		StartBenchmark(game, &game->data->benchmark, benchmark_output, launch);
+		BenchmarkStage(game, "libsuperderpy_init", game->data->benchmark.origin, start);
+		BenchmarkStage(game, "CreateGameData", start, al_get_time());
+	}
+	if (board_benchmark) {
+		StartBoardBenchmark(game, &game->data->benchmark, board_output, baseline);
+	}
+	if (stress_benchmark) {
+		StartStressBenchmark(game, &game->data->benchmark, stress_output, minutes, speed);
+	}
+
 	LoadGamestate(game, "menu");
 	LoadGamestate(game, "settings");
 	LoadGamestate(game, "game");
 
-	StartGamestate(game, "menu");
-
-	game->data = CreateGameData(game);
+	if (board_benchmark || stress_benchmark) {
+		// both run on the infinite level as soon as the game gets started, no need to go through the menu
+		game->data->level = 0;
+		StartGamestate(game, "game");
+	} else {
+		StartGamestate(game, "menu");
+	}
 
 	al_show_mouse_cursor(game->display);
 
@@ -0,0 +1,276 @@
+/*! \file progress.c
+ *  \brief Binary store for the player's progress.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common.h"
+
+/*
+ * The file consists of a header followed by one fixed-size record per level,
+ * indexed by level id. Updating a single level only rewrites its own record.
+ *
+ * Progress gets imported from the config file only when there's no progress
+ * file at all. A file written by a newer version is never written to, and
+ * a damaged one is left as is until there's something new to store.
+ */
+
+#define PROGRESS_FILENAME "progress.dat"
+#define PROGRESS_MAGIC "ANIMATCH_PROGR"
+#define PROGRESS_MAGIC_LENGTH 14
+#define PROGRESS_VERSION 1
+#define PROGRESS_HEADER_SIZE (PROGRESS_MAGIC_LENGTH + 4)
+#define PROGRESS_RECORD_SIZE (2 + 4 * 4)
+
+#define PROGRESS_FLAG_UNLOCKED 1
+#define PROGRESS_FLAG_FINISHED 2
+
+static ALLEGRO_PATH* GetProgressPath(void) {
+	ALLEGRO_PATH* path = al_get_standard_path(ALLEGRO_USER_DATA_PATH);
+	if (!al_filename_exists(al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP))) {
+		al_make_directory(al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP));
+	}
+	al_set_path_filename(path, PROGRESS_FILENAME);
+	return path;
+}
+
+static void ClearLevelProgress(struct LevelProgress* level) {
+	level->unlocked = false;
+	level->finished = false;
+	level->score_score = 0;
+	level->score_moves = 99999;
+	level->moves_score = 0;
+	level->moves_moves = 99999;
+}
+
+static bool EnsureProgressCapacity(struct Progress* progress, int count) {
+	if (count <= progress->count) {
+		return true;
+	}
+	struct LevelProgress* levels = realloc(progress->levels, count * sizeof(struct LevelProgress));
+	if (!levels) {
+		return false;
+	}
+	progress->levels = levels;
+	for (int i = progress->count; i < count; i++) {
+		ClearLevelProgress(&progress->levels[i]);
+	}
+	progress->count = count;
+	return true;
+}
+
+static void WriteRecord(ALLEGRO_FILE* file, struct LevelProgress* level) {
+	al_fwrite16le(file, (level->unlocked ? PROGRESS_FLAG_UNLOCKED : 0) | (level->finished ? PROGRESS_FLAG_FINISHED : 0));
+	al_fwrite32le(file, level->score_score);
+	al_fwrite32le(file, level->score_moves);
+	al_fwrite32le(file, level->moves_score);
+	al_fwrite32le(file, level->moves_moves);
+}
+
+static void ReadRecord(ALLEGRO_FILE* file, struct LevelProgress* level) {
+	int flags = al_fread16le(file);
+	level->unlocked = flags & PROGRESS_FLAG_UNLOCKED;
+	level->finished = flags & PROGRESS_FLAG_FINISHED;
+	level->score_score = al_fread32le(file);
+	level->score_moves = al_fread32le(file);
+	level->moves_score = al_fread32le(file);
+	level->moves_moves = al_fread32le(file);
+}
+
+static void WriteProgress(struct Game* game, struct Progress* progress) {
+	if (progress->readonly) {
+		return;
+	}
+	ALLEGRO_PATH* path = GetProgressPath();
+	const char* filename = al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP);
+	ALLEGRO_FILE* file = al_fopen(filename, "wb");
+	if (!file) {
+		PrintConsole(game, "Could not open progress file for writing: %s", filename);
+		al_destroy_path(path);
+		return;
+	}
+	al_fwrite(file, PROGRESS_MAGIC, PROGRESS_MAGIC_LENGTH);
+	al_fwrite32le(file, PROGRESS_VERSION);
+	for (int i = 0; i < progress->count; i++) {
+		WriteRecord(file, &progress->levels[i]);
+	}
+	progress->damaged = false;
+	al_fclose(file);
+	al_destroy_path(path);
+}
+
+static void ReadProgress(struct Game* game, struct Progress* progress, const char* filename) {
+	ALLEGRO_FILE* file = al_fopen(filename, "rb");
+	if (!file) {
+		PrintConsole(game, "Could not open progress file: %s", filename);
+		progress->damaged = true;
+		return;
+	}
+
+	char buf[PROGRESS_MAGIC_LENGTH];
+	if (al_fsize(file) < PROGRESS_HEADER_SIZE || al_fread(file, buf, PROGRESS_MAGIC_LENGTH) != PROGRESS_MAGIC_LENGTH || strncmp(PROGRESS_MAGIC, buf, PROGRESS_MAGIC_LENGTH) != 0) {
+		PrintConsole(game, "Incorrect progress data: %s", filename);
+		progress->damaged = true;
+		goto end;
+	}
+	int version = al_fread32le(file);
+	if (version > PROGRESS_VERSION) {
+		PrintConsole(game, "Incompatible version (%d) of progress data, not saving any progress: %s", version, filename);
+		progress->readonly = true;
+		goto end;
+	}
+
+	// a truncated last record is simply dropped
+	int count = (int)((al_fsize(file) - PROGRESS_HEADER_SIZE) / PROGRESS_RECORD_SIZE);
+	if (!EnsureProgressCapacity(progress, count)) {
+		PrintConsole(game, "Could not allocate progress of %d levels!", count);
+		progress->readonly = true;
+		goto end;
+	}
+	for (int i = 0; i < count; i++) {
+		ReadRecord(file, &progress->levels[i]);
+	}
+
+end:
+	al_fclose(file);
+}
+
+static void ImportProgress(struct Game* game, struct Progress* progress) {
+	// migrate from per-level entries in the config file used by older versions
+	int unlocked = strtol(GetConfigOptionDefault(game, "Animatch", "unlocked_levels", "1"), NULL, 0);
+	if (!EnsureProgressCapacity(progress, unlocked + 1)) {
+		PrintConsole(game, "Could not allocate progress of %d levels!", unlocked + 1);
+		return;
+	}
+	for (int i = 0; i <= unlocked; i++) {
+		struct LevelProgress* level = &progress->levels[i];
+		level->unlocked = true;
+
+		char namescore[255] = {}, namemoves[255] = {};
+		snprintf(namescore, 255, "level%d-score", i);
+		snprintf(namemoves, 255, "level%d-moves", i);
+
+		if (GetConfigOption(game, namescore, "score")) {
+			level->finished = true;
+			level->score_score = strtol(GetConfigOptionDefault(game, namescore, "score", "0"), NULL, 0);
+			level->score_moves = strtol(GetConfigOptionDefault(game, namescore, "moves", "99999"), NULL, 0);
+		}
+		if (GetConfigOption(game, namemoves, "moves")) {
+			level->finished = true;
+			level->moves_score = strtol(GetConfigOptionDefault(game, namemoves, "score", "0"), NULL, 0);
+			level->moves_moves = strtol(GetConfigOptionDefault(game, namemoves, "moves", "99999"), NULL, 0);
+		}
+	}
+	PrintConsole(game, "Imported progress of %d levels from config file.", progress->count);
+	WriteProgress(game, progress);
+}
+
+void LoadProgress(struct Game* game, struct Progress* progress) {
+	progress->levels = NULL;
+	progress->count = 0;
+	progress->readonly = false;
+	progress->damaged = false;
+
+	ALLEGRO_PATH* path = GetProgressPath();
+	const char* filename = al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP);
+	if (al_filename_exists(filename)) {
+		ReadProgress(game, progress, filename);
+	} else {
+		ImportProgress(game, progress);
+	}
+	al_destroy_path(path);
+
+	// levels 0 (infinite) and 1 are always available
+	if (!EnsureProgressCapacity(progress, 2)) {
+		FatalError(game, true, "Could not allocate progress data!");
+		return;
+	}
+	progress->levels[0].unlocked = true;
+	progress->levels[1].unlocked = true;
+}
+
+void DestroyProgress(struct Game* game, struct Progress* progress) {
+	free(progress->levels);
+	progress->levels = NULL;
+	progress->count = 0;
+}
+
+struct LevelProgress* GetLevelProgress(struct Game* game, struct Progress* progress, int level) {
+	if (level < 0 || !EnsureProgressCapacity(progress, level + 1)) {
+		return NULL;
+	}
+	return &progress->levels[level];
+}
+
+void StoreLevelProgress(struct Game* game, struct Progress* progress, int level) {
+	if (level < 0 || level >= progress->count || progress->readonly) {
+		return;
+	}
+	if (progress->damaged) {
+		WriteProgress(game, progress);
+		return;
+	}
+	ALLEGRO_PATH* path = GetProgressPath();
+	const char* filename = al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP);
+	ALLEGRO_FILE* file = NULL;
+	if (al_filename_exists(filename)) {
+		file = al_fopen(filename, "r+b");
+	}
+	if (!file) {
+		al_destroy_path(path);
+		WriteProgress(game, progress);
+		return;
+	}
+
+	int64_t size = al_fsize(file);
+	if (size < PROGRESS_HEADER_SIZE) {
+		// got damaged since it was read
+		al_fclose(file);
+		al_destroy_path(path);
+		WriteProgress(game, progress);
+		return;
+	}
+	int64_t offset = PROGRESS_HEADER_SIZE + level * (int64_t)PROGRESS_RECORD_SIZE;
+	if (offset > size) {
+		// records in between haven't been stored yet
+		al_fseek(file, size - (size - PROGRESS_HEADER_SIZE) % PROGRESS_RECORD_SIZE, ALLEGRO_SEEK_SET);
+		for (int i = (int)((size - PROGRESS_HEADER_SIZE) / PROGRESS_RECORD_SIZE); i < level; i++) {
+			WriteRecord(file, &progress->levels[i]);
+		}
+	} else {
+		al_fseek(file, offset, ALLEGRO_SEEK_SET);
+	}
+	WriteRecord(file, &progress->levels[level]);
+
+	al_fclose(file);
+	al_destroy_path(path);
+}
+
+void ResetProgress(struct Game* game, struct Progress* progress) {
+	for (int i = 2; i < progress->count; i++) {
+		progress->levels[i].unlocked = false;
+	}
+	WriteProgress(game, progress);
+}
+
+int CountUnlockedLevels(struct Game* game, struct Progress* progress) {
+	int unlocked = 1;
+	while (unlocked + 1 < progress->count && progress->levels[unlocked + 1].unlocked) {
+		unlocked++;
+	}
+	return unlocked;
+}
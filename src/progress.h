@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ANIMATCH_PROGRESS_H
+#define ANIMATCH_PROGRESS_H
+
+#include <stdbool.h>
+
+struct Game;
+
+struct LevelProgress {
+	bool unlocked, finished;
+	// best score (and moves it took to get it)
+	int score_score, score_moves;
+	// fewest moves (and score achieved with them)
+	int moves_score, moves_moves;
+};
+
+struct Progress {
+	struct LevelProgress* levels;
+	int count;
+	// set when the file on disk comes from a newer version and must be left alone
+	bool readonly;
+	// set when the file on disk is damaged, so it gets rewritten as a whole
+	bool damaged;
+};
+
+void LoadProgress(struct Game* game, struct Progress* progress);
+void DestroyProgress(struct Game* game, struct Progress* progress);
+struct LevelProgress* GetLevelProgress(struct Game* game, struct Progress* progress, int level);
+void StoreLevelProgress(struct Game* game, struct Progress* progress, int level);
+void ResetProgress(struct Game* game, struct Progress* progress);
+int CountUnlockedLevels(struct Game* game, struct Progress* progress);
+
+#endif
@@ -41,21 +41,85 @@ void SetScrollingViewportAsTarget(struct Game* game, struct ScrollingViewport* v
 	}
 }
 
-void UpdateScrollingViewport(struct Game* game, struct ScrollingViewport* viewport) {
-	if (!viewport->pressed) {
-		viewport->speed *= 0.95;
-		viewport->pos += viewport->speed * game->viewport.height;
+/*
+ * Scrolling is simulated in real time rather than per tick, so it feels the same
+ * no matter how often it gets updated. While dragged, the content follows the
+ * pointer and the last few pointer positions are kept; on release, the velocity
+ * is estimated from those that fall into a short window, which smooths out
+ * irregular event timing. Afterwards the content glides on with exponentially
+ * decaying speed. Dragging past the ends meets increasing resistance and any
+ * overscroll springs back once released.
+ *
+ * Speed is in pixels per second.
+ */
 
-		if (viewport->pos < 0) {
-			viewport->pos *= 0.75;
-			viewport->speed *= 0.2;
-		}
-		if (viewport->pos > viewport->content - viewport->h) {
-			double diff = viewport->pos - (viewport->content - viewport->h);
-			diff *= 0.25;
-			viewport->pos -= diff;
-			viewport->speed *= 0.2;
+#define SCROLLING_FRICTION 3.08 // speed decay rate, per second
+#define SCROLLING_SPRING 17.3 // rate at which overscroll gets pulled back, per second
+#define SCROLLING_BOUNCE_FRICTION 96.6 // speed decay rate while overscrolled, per second
+#define SCROLLING_RUBBER_BAND 0.5 // how much of the drag makes it past the ends at first
+#define SCROLLING_SAMPLE_WINDOW 0.1 // seconds of pointer history used to estimate velocity
+#define SCROLLING_MIN_SPEED 1.0
+
+static double GetOverscroll(struct ScrollingViewport* viewport, double pos) {
+	double max = fmax(0, viewport->content - viewport->h);
+	if (pos < 0) {
+		return pos;
+	}
+	if (pos > max) {
+		return pos - max;
+	}
+	return 0;
+}
+
+static double GetEventTimestamp(ALLEGRO_EVENT* ev) {
+	if ((ev->type == ALLEGRO_EVENT_TOUCH_BEGIN) || (ev->type == ALLEGRO_EVENT_TOUCH_MOVE) || (ev->type == ALLEGRO_EVENT_TOUCH_END) || (ev->type == ALLEGRO_EVENT_TOUCH_CANCEL)) {
+		return ev->touch.timestamp;
+	}
+	return ev->mouse.timestamp;
+}
+
+static void AddScrollingSample(struct ScrollingViewport* viewport, double time, double y) {
+	viewport->sample = (viewport->sample + 1) % SCROLLING_SAMPLES;
+	viewport->samples[viewport->sample].time = time;
+	viewport->samples[viewport->sample].y = y;
+	viewport->samples[viewport->sample].valid = true;
+}
+
+static double EstimateScrollingSpeed(struct ScrollingViewport* viewport, double now) {
+	// from the newest sample back to the oldest one within the window
+	int newest = viewport->sample, oldest = newest;
+	if (!viewport->samples[newest].valid || (now - viewport->samples[newest].time > SCROLLING_SAMPLE_WINDOW)) {
+		// the pointer has been resting for a while
+		return 0;
+	}
+	for (int i = 1; i < SCROLLING_SAMPLES; i++) {
+		int n = (newest - i + SCROLLING_SAMPLES) % SCROLLING_SAMPLES;
+		if (!viewport->samples[n].valid || (now - viewport->samples[n].time > SCROLLING_SAMPLE_WINDOW)) {
+			break;
 		}
+		oldest = n;
+	}
+	double time = viewport->samples[newest].time - viewport->samples[oldest].time;
+	if (time <= 0) {
+		return 0;
+	}
+	return (viewport->samples[oldest].y - viewport->samples[newest].y) / time;
+}
+
+void UpdateScrollingViewport(struct Game* game, struct ScrollingViewport* viewport, double delta) {
+	if (viewport->pressed) {
+		return;
+	}
+	viewport->pos += viewport->speed * delta;
+	viewport->speed *= exp(-SCROLLING_FRICTION * delta);
+
+	double overscroll = GetOverscroll(viewport, viewport->pos);
+	if (overscroll) {
+		viewport->pos -= overscroll * (1.0 - exp(-SCROLLING_SPRING * delta));
+		viewport->speed *= exp(-SCROLLING_BOUNCE_FRICTION * delta);
+	}
+	if (fabs(viewport->speed) < SCROLLING_MIN_SPEED) {
+		viewport->speed = 0;
 	}
 }
 
@@ -69,11 +133,11 @@ void ProcessScrollingViewportEvent(struct Game* game, ALLEGRO_EVENT* ev, struct
 		}
 	}
 	if ((ev->type == ALLEGRO_EVENT_TOUCH_END) || (ev->type == ALLEGRO_EVENT_TOUCH_CANCEL) || (ev->type == ALLEGRO_EVENT_MOUSE_BUTTON_UP)) {
+		if (viewport->triggered) {
+			viewport->speed = EstimateScrollingSpeed(viewport, GetEventTimestamp(ev));
+		}
 		viewport->pressed = false;
 		viewport->triggered = false;
-		if (fabs(viewport->speed) < 0.001) {
-			viewport->speed = 0;
-		}
 	}
 	if ((ev->type == ALLEGRO_EVENT_TOUCH_MOVE) || (ev->type == ALLEGRO_EVENT_MOUSE_AXES)) {
 		if (ev->type == ALLEGRO_EVENT_TOUCH_MOVE) {
@@ -83,34 +147,31 @@ void ProcessScrollingViewportEvent(struct Game* game, ALLEGRO_EVENT* ev, struct
 			viewport->offsetX += ev->mouse.dx / (float)game->viewport.width;
 			viewport->offsetY += ev->mouse.dy / (float)game->viewport.height;
 		}
+		double y = game->data->mouseY * game->viewport.height;
+
 		if (viewport->pressed && !viewport->triggered && ((fabs(viewport->offsetX) > 0.02) || (fabs(viewport->offsetY) > 0.02))) {
-			double timestamp;
-			if (ev->type == ALLEGRO_EVENT_TOUCH_BEGIN) {
-				timestamp = ev->touch.timestamp;
-			} else {
-				timestamp = ev->mouse.timestamp;
-			}
 			viewport->triggered = true;
-			viewport->lasty = game->data->mouseY;
-			viewport->lasttime = timestamp;
+			viewport->lasty = y;
+			for (int i = 0; i < SCROLLING_SAMPLES; i++) {
+				viewport->samples[i].valid = false;
+			}
+			AddScrollingSample(viewport, GetEventTimestamp(ev), y);
 		}
 
 		if (viewport->triggered) {
-			double timestamp;
-			if (ev->type == ALLEGRO_EVENT_TOUCH_MOVE) {
-				timestamp = ev->touch.timestamp;
-			} else {
-				timestamp = ev->mouse.timestamp;
-			}
-
-			if (timestamp - viewport->lasttime) {
-				viewport->speed = (viewport->lasty - game->data->mouseY) / ((timestamp - viewport->lasttime) * 1000) * 16.666;
+			double move = viewport->lasty - y;
+			double overscroll = GetOverscroll(viewport, viewport->pos);
+			if (overscroll && ((overscroll > 0) == (move > 0))) {
+				// the further past the end, the less it gives
+				move *= SCROLLING_RUBBER_BAND * viewport->h / (viewport->h + fabs(overscroll));
 			}
+			viewport->pos += move;
+			viewport->lasty = y;
 
-			viewport->pos += (viewport->lasty - game->data->mouseY) * game->viewport.height;
-
-			viewport->lasty = game->data->mouseY;
-			viewport->lasttime = timestamp;
+			// motion events are coalesced (see CoalesceMotion in common.c), so samples
+			// come roughly once per frame rather than once per digitizer report
+			AddScrollingSample(viewport, GetEventTimestamp(ev), y);
+			viewport->speed = EstimateScrollingSpeed(viewport, GetEventTimestamp(ev));
 		}
 	}
 	if (ev->type == ALLEGRO_EVENT_MOUSE_AXES) {
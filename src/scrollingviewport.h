@@ -19,21 +19,28 @@
 
 #include "common.h"
 
+#define SCROLLING_SAMPLES 16
+
 struct ScrollingViewport {
 	double pos;
-	double speed;
+	double speed; // pixels per second
 	double offsetX, offsetY;
 	bool pressed, triggered;
-	double lasttime;
 	double lasty;
 
+	struct {
+		double time, y;
+		bool valid;
+	} samples[SCROLLING_SAMPLES]; // recent pointer positions, for estimating velocity
+	int sample; // the newest one
+
 	int x, y, w, h;
 	int content;
 };
 
 void SetScrollingViewportPosition(struct Game* game, struct ScrollingViewport* viewport, int x, int y, int w, int h, int content);
 void SetScrollingViewportAsTarget(struct Game* game, struct ScrollingViewport* viewport);
-void UpdateScrollingViewport(struct Game* game, struct ScrollingViewport* viewport);
+void UpdateScrollingViewport(struct Game* game, struct ScrollingViewport* viewport, double delta);
 void ProcessScrollingViewportEvent(struct Game* game, ALLEGRO_EVENT* ev, struct ScrollingViewport* viewport);
 
 #endif
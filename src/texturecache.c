@@ -0,0 +1,267 @@
+/*! \file texturecache.c
+ *  \brief On-disk cache of decoded textures.
+ */
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common.h"
+
+/*
+ * Decoding large WebP images takes a noticeable part of the startup time, so
+ * their decoded pixels are kept in the user data directory. Every cached file
+ * is named after its source and stores its size and modification time along
+ * with the revision of the game that wrote it, so a changed asset simply
+ * overwrites its stale entry on the next load. The revision covers assets
+ * that have no meaningful modification time (such as the ones packed in an
+ * APK) or that got rebuilt with the same size and time.
+ *
+ * Edge profiles (see GetBitmapEdgeProfile) get cached next to them the same
+ * way, keyed on the source image and on the parameters they were taken with,
+ * so the bitmap doesn't have to be read back at all on warm starts.
+ */
+
+#define TEXTURE_CACHE_DIRECTORY "texture-cache"
+#define TEXTURE_CACHE_MAGIC "ANIMATCH_TEXTR"
+#define TEXTURE_CACHE_MAGIC_LENGTH 14
+#define TEXTURE_CACHE_VERSION 3
+#define TEXTURE_CACHE_STAMP 3
+#define TEXTURE_CACHE_HEADER_SIZE (TEXTURE_CACHE_MAGIC_LENGTH + 4 * (3 + TEXTURE_CACHE_STAMP * 2))
+#define TEXTURE_CACHE_FORMAT ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE
+
+#define EDGE_CACHE_MAGIC "ANIMATCH_EDGES"
+#define EDGE_CACHE_VERSION 2
+#define EDGE_CACHE_PARAMS 4
+#define EDGE_CACHE_HEADER_SIZE (TEXTURE_CACHE_MAGIC_LENGTH + 4 * (1 + TEXTURE_CACHE_STAMP * 2 + EDGE_CACHE_PARAMS))
+
+static bool GetSourceStamp(const char* filename, uint64_t* stamp) {
+	// Reading and hashing the whole source would eat much of what the cache saves,
+	// so entries are keyed on the size and modification time of the source instead,
+	// plus a hash (FNV-1a) of the game's version and revision.
+	uint64_t revision = 0xCBF29CE484222325ULL;
+	for (const char* c = LIBSUPERDERPY_GAME_VERSION "-" LIBSUPERDERPY_GAME_GIT_REV; *c; c++) {
+		revision = (revision ^ (unsigned char)*c) * 0x100000001B3ULL;
+	}
+	stamp[2] = revision;
+
+	ALLEGRO_FS_ENTRY* entry = al_create_fs_entry(filename);
+	if (!entry) {
+		return false;
+	}
+	bool ok = al_update_fs_entry(entry) && al_fs_entry_exists(entry);
+	stamp[0] = (uint64_t)al_get_fs_entry_size(entry);
+	stamp[1] = (uint64_t)al_get_fs_entry_mtime(entry);
+	al_destroy_fs_entry(entry);
+	return ok;
+}
+
+static ALLEGRO_PATH* GetCachePath(const char* filename, const char* extension) {
+	ALLEGRO_PATH* path = al_get_standard_path(ALLEGRO_USER_DATA_PATH);
+	al_append_path_component(path, TEXTURE_CACHE_DIRECTORY);
+	if (!al_filename_exists(al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP))) {
+		al_make_directory(al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP));
+	}
+
+	char name[255];
+	snprintf(name, 255, "%s.%s", filename, extension);
+	for (char* c = name; *c; c++) {
+		if (*c == '/' || *c == '\\') {
+			*c = '_';
+		}
+	}
+	al_set_path_filename(path, name);
+	return path;
+}
+
+static bool ReadCacheHeader(ALLEGRO_FILE* file, const char* magic, uint32_t version, uint64_t* stamp) {
+	char buffer[TEXTURE_CACHE_MAGIC_LENGTH];
+	if ((al_fread(file, buffer, TEXTURE_CACHE_MAGIC_LENGTH) != TEXTURE_CACHE_MAGIC_LENGTH) || memcmp(buffer, magic, TEXTURE_CACHE_MAGIC_LENGTH) != 0) {
+		return false;
+	}
+	if ((uint32_t)al_fread32le(file) != version) {
+		return false;
+	}
+	for (int i = 0; i < TEXTURE_CACHE_STAMP; i++) {
+		uint64_t value = (uint32_t)al_fread32le(file);
+		value |= (uint64_t)(uint32_t)al_fread32le(file) << 32;
+		if (value != stamp[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void WriteCacheHeader(ALLEGRO_FILE* file, const char* magic, uint32_t version, uint64_t* stamp) {
+	al_fwrite(file, magic, TEXTURE_CACHE_MAGIC_LENGTH);
+	al_fwrite32le(file, version);
+	for (int i = 0; i < TEXTURE_CACHE_STAMP; i++) {
+		al_fwrite32le(file, stamp[i] & 0xFFFFFFFF);
+		al_fwrite32le(file, stamp[i] >> 32);
+	}
+}
+
+static ALLEGRO_BITMAP* ReadCachedBitmap(const char* filename, uint64_t* stamp) {
+	ALLEGRO_FILE* file = al_fopen(filename, "rb");
+	if (!file) {
+		return NULL;
+	}
+
+	if (!ReadCacheHeader(file, TEXTURE_CACHE_MAGIC, TEXTURE_CACHE_VERSION, stamp)) {
+		al_fclose(file);
+		return NULL;
+	}
+	int width = al_fread32le(file);
+	int height = al_fread32le(file);
+
+	// a cache entry left incomplete (e.g. by a crash) is rejected by the size check
+	if (width <= 0 || height <= 0 || al_fsize(file) != TEXTURE_CACHE_HEADER_SIZE + (int64_t)width * height * 4) {
+		al_fclose(file);
+		return NULL;
+	}
+
+	ALLEGRO_BITMAP* bitmap = al_create_bitmap(width, height);
+	if (!bitmap) {
+		al_fclose(file);
+		return NULL;
+	}
+	ALLEGRO_LOCKED_REGION* region = al_lock_bitmap(bitmap, TEXTURE_CACHE_FORMAT, ALLEGRO_LOCK_WRITEONLY);
+	bool ok = region != NULL;
+	for (int y = 0; ok && y < height; y++) {
+		ok = al_fread(file, (char*)region->data + y * region->pitch, width * 4) == (size_t)(width * 4);
+	}
+	if (region) {
+		al_unlock_bitmap(bitmap);
+	}
+	al_fclose(file);
+
+	if (!ok) {
+		al_destroy_bitmap(bitmap);
+		return NULL;
+	}
+	return bitmap;
+}
+
+static bool WriteCachedBitmap(const char* filename, uint64_t* stamp, ALLEGRO_BITMAP* bitmap) {
+	ALLEGRO_LOCKED_REGION* region = al_lock_bitmap(bitmap, TEXTURE_CACHE_FORMAT, ALLEGRO_LOCK_READONLY);
+	if (!region) {
+		return false;
+	}
+	ALLEGRO_FILE* file = al_fopen(filename, "wb");
+	if (!file) {
+		al_unlock_bitmap(bitmap);
+		return false;
+	}
+
+	int width = al_get_bitmap_width(bitmap), height = al_get_bitmap_height(bitmap);
+	WriteCacheHeader(file, TEXTURE_CACHE_MAGIC, TEXTURE_CACHE_VERSION, stamp);
+	al_fwrite32le(file, width);
+	al_fwrite32le(file, height);
+	for (int y = 0; y < height; y++) {
+		al_fwrite(file, (char*)region->data + y * region->pitch, width * 4);
+	}
+	bool ok = !al_ferror(file);
+	al_fclose(file);
+	al_unlock_bitmap(bitmap);
+	return ok;
+}
+
+static bool ReadCachedEdgeProfile(const char* filename, uint64_t* stamp, int32_t* params, int length, int* profile) {
+	ALLEGRO_FILE* file = al_fopen(filename, "rb");
+	if (!file) {
+		return false;
+	}
+	bool ok = ReadCacheHeader(file, EDGE_CACHE_MAGIC, EDGE_CACHE_VERSION, stamp) &&
+		al_fsize(file) == EDGE_CACHE_HEADER_SIZE + (int64_t)length * 4;
+	for (int i = 0; ok && i < EDGE_CACHE_PARAMS; i++) {
+		ok = al_fread32le(file) == params[i];
+	}
+	for (int i = 0; ok && i < length; i++) {
+		profile[i] = al_fread32le(file);
+	}
+	ok = ok && !al_ferror(file);
+	al_fclose(file);
+	return ok;
+}
+
+static bool WriteCachedEdgeProfile(const char* filename, uint64_t* stamp, int32_t* params, int length, int* profile) {
+	ALLEGRO_FILE* file = al_fopen(filename, "wb");
+	if (!file) {
+		return false;
+	}
+	WriteCacheHeader(file, EDGE_CACHE_MAGIC, EDGE_CACHE_VERSION, stamp);
+	for (int i = 0; i < EDGE_CACHE_PARAMS; i++) {
+		al_fwrite32le(file, params[i]);
+	}
+	for (int i = 0; i < length; i++) {
+		al_fwrite32le(file, profile[i]);
+	}
+	bool ok = !al_ferror(file);
+	al_fclose(file);
+	return ok;
+}
+
+ALLEGRO_BITMAP* DecodeCachedBitmap(const char* source, const char* filename, bool cache_enabled) {
+	// Doesn't touch any engine state, so it can be used from threads other than the main one.
+	uint64_t stamp[TEXTURE_CACHE_STAMP];
+	if (!cache_enabled || !GetSourceStamp(source, stamp)) {
+		return al_load_bitmap(source);
+	}
+
+	ALLEGRO_PATH* path = GetCachePath(filename, "tex");
+	const char* cache = al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP);
+	ALLEGRO_BITMAP* bitmap = ReadCachedBitmap(cache, stamp);
+	if (!bitmap) {
+		bitmap = al_load_bitmap(source);
+		if (bitmap) {
+			WriteCachedBitmap(cache, stamp, bitmap);
+		}
+	}
+	al_destroy_path(path);
+	return bitmap;
+}
+
+ALLEGRO_BITMAP* LoadBitmapWithCache(struct Game* game, const char* filename, bool cache_enabled) {
+	return DecodeCachedBitmap(GetDataFilePath(game, filename), filename, cache_enabled);
+}
+
+ALLEGRO_BITMAP* LoadCachedBitmap(struct Game* game, const char* filename) {
+	return LoadBitmapWithCache(game, filename, game->data->config.texture_cache);
+}
+
+void LoadCachedEdgeProfile(struct Game* game, const char* filename, ALLEGRO_BITMAP* bitmap, int x, int y, int length, float alpha, int* profile) {
+	// <bitmap> has to be the one loaded from <filename>, as the entry is only checked against the latter
+	uint64_t stamp[TEXTURE_CACHE_STAMP];
+	if (!game->data->config.texture_cache || !GetSourceStamp(GetDataFilePath(game, filename), stamp)) {
+		GetBitmapEdgeProfile(game, bitmap, x, y, length, alpha, profile);
+		return;
+	}
+
+	// the threshold is stored bit for bit, so any change to it invalidates the entry
+	union {
+		float f;
+		int32_t i;
+	} threshold = {.f = alpha};
+	int32_t params[EDGE_CACHE_PARAMS] = {x, y, length, threshold.i};
+	ALLEGRO_PATH* path = GetCachePath(filename, "edge");
+	const char* cache = al_path_cstr(path, ALLEGRO_NATIVE_PATH_SEP);
+	if (!ReadCachedEdgeProfile(cache, stamp, params, length, profile)) {
+		GetBitmapEdgeProfile(game, bitmap, x, y, length, alpha, profile);
+		if (!WriteCachedEdgeProfile(cache, stamp, params, length, profile)) {
+			PrintConsole(game, "Could not write edge profile cache entry: %s", cache);
+		}
+	}
+	al_destroy_path(path);
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) Sebastian Krzyszkowiak <dos@dosowisko.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ANIMATCH_TEXTURECACHE_H
+#define ANIMATCH_TEXTURECACHE_H
+
+#include "common.h"
+
+ALLEGRO_BITMAP* DecodeCachedBitmap(const char* source, const char* filename, bool cache_enabled);
+ALLEGRO_BITMAP* LoadBitmapWithCache(struct Game* game, const char* filename, bool cache_enabled);
+ALLEGRO_BITMAP* LoadCachedBitmap(struct Game* game, const char* filename);
+void LoadCachedEdgeProfile(struct Game* game, const char* filename, ALLEGRO_BITMAP* bitmap, int x, int y, int length, float alpha, int* profile);
+
+#endif